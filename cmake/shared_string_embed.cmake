@@ -0,0 +1,73 @@
+# Distributed under the Boost Software License, Version 1.0.
+#    (See accompanying file LICENSE_1_0.txt or copy at
+#          https://www.boost.org/LICENSE_1_0.txt)
+
+# shared_string_embed(<target> FILE <path> NAME <identifier> [NAMESPACE <namespace>])
+#
+# Generates the header <identifier>.hpp, in an include directory added to the target, which exposes the contents of the file
+# as an immortal kab::shared_string constant <namespace>::<identifier> backed by static storage, like a literal
+# The header is generated again whenever the file changes
+
+if(CMAKE_SCRIPT_MODE_FILE)
+	# Invoked at build time with INPUT, OUTPUT, NAME and NAMESPACE
+	file(READ "${INPUT}" content HEX)
+	string(LENGTH "${content}" hex_length)
+	math(EXPR size "${hex_length} / 2")
+	# 16 characters per line
+	set(characters "")
+	foreach(offset RANGE 0 ${hex_length} 32)
+		string(SUBSTRING "${content}" ${offset} 32 line)
+		if(NOT line STREQUAL "")
+			string(REGEX REPLACE "([0-9a-f][0-9a-f])" "'\\\\x\\1'," line "${line}")
+			string(APPEND characters "${line}\n\t\t\t")
+		endif()
+	endforeach()
+
+	file(WRITE "${OUTPUT}.tmp"
+"// Generated by shared_string_embed from ${INPUT}, do not edit
+
+#pragma once
+
+#include <shared_string.hpp>
+
+#include <string_view>
+
+namespace ${NAMESPACE} {
+	namespace ${NAME}_detail {
+		inline constexpr char characters[] = {
+			${characters}'\\0'
+		};
+	}
+
+	SHARED_STRING_CONSTEXPR20 kab::shared_string const ${NAME} = kab::shared_string::from_static(std::string_view(${NAME}_detail::characters, ${size}));
+}
+")
+	file(RENAME "${OUTPUT}.tmp" "${OUTPUT}")
+	return()
+endif()
+
+set(SHARED_STRING_EMBED_SCRIPT "${CMAKE_CURRENT_LIST_FILE}")
+
+function(shared_string_embed target)
+	cmake_parse_arguments(EMBED "" "FILE;NAME;NAMESPACE" "" ${ARGN})
+	if(NOT EMBED_FILE OR NOT EMBED_NAME)
+		message(FATAL_ERROR "shared_string_embed requires FILE and NAME")
+	endif()
+	if(NOT EMBED_NAMESPACE)
+		set(EMBED_NAMESPACE embedded)
+	endif()
+
+	get_filename_component(input "${EMBED_FILE}" ABSOLUTE)
+	set(include_dir "${CMAKE_CURRENT_BINARY_DIR}/${target}_embedded")
+	set(output "${include_dir}/${EMBED_NAME}.hpp")
+
+	add_custom_command(
+		OUTPUT "${output}"
+		COMMAND "${CMAKE_COMMAND}" -DINPUT=${input} -DOUTPUT=${output} -DNAME=${EMBED_NAME} -DNAMESPACE=${EMBED_NAMESPACE} -P "${SHARED_STRING_EMBED_SCRIPT}"
+		DEPENDS "${input}" "${SHARED_STRING_EMBED_SCRIPT}"
+		COMMENT "Embedding ${EMBED_FILE} as ${EMBED_NAMESPACE}::${EMBED_NAME}"
+		VERBATIM
+	)
+	target_sources(${target} PRIVATE "${output}")
+	target_include_directories(${target} PRIVATE "${include_dir}")
+endfunction()
@@ -7,9 +7,35 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
+#include <array>
+#include <iterator>
 #include <atomic>
+#include <type_traits>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <stdexcept>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <cassert>
+#if __has_include(<version>)
+#include <version>
+#endif
+#ifdef __cpp_lib_ranges
+#include <ranges>
+#endif
+#ifdef __cpp_lib_span
+#include <span>
+#endif
+
+// Strings can only be constants if their destructor can run at compile time, which requires C++20
+#if __cpp_constexpr >= 201907L
+#define SHARED_STRING_CONSTEXPR20 constexpr
+#else
+#define SHARED_STRING_CONSTEXPR20 inline
+#endif
 
 namespace kab
 {
@@ -20,11 +46,104 @@ namespace kab
 	>
 	class basic_shared_string;
 
-	namespace literals {
-		auto operator""_ss(char const* str, std::size_t size)->basic_shared_string<char>;
-		auto operator""_ss(wchar_t const* str, std::size_t size)->basic_shared_string<wchar_t>;
-		auto operator""_ss(char16_t const* str, std::size_t size)->basic_shared_string<char16_t>;
-		auto operator""_ss(char32_t const* str, std::size_t size)->basic_shared_string<char32_t>;
+	template<
+		typename CharT,
+		typename Traits = std::char_traits<CharT>,
+		typename Allocator = std::allocator<CharT>
+	>
+	class basic_shared_string_ref;
+
+	namespace detail {
+		struct literal_access;
+		struct bulk_access;
+		struct flags_access;
+
+		// Properties of the characters of a block, cached in its header by the functions computing them
+		// Each property has a bit telling whether it was computed yet, and a bit holding its value
+		enum block_flag : unsigned {
+			block_lower_known = 1u << 0,
+			block_is_lower = 1u << 1, // no ASCII upper case letter
+			block_ascii_known = 1u << 2,
+			block_is_ascii = 1u << 3,
+			block_utf8_known = 1u << 4,
+			block_is_utf8 = 1u << 5, // valid UTF-8
+			block_writable = 1u << 6, // its owner may still write characters no string views yet, so no property is cached
+		};
+
+		inline void prefetch_for_write(void const* p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+			__builtin_prefetch(p, 1);
+#else
+			(void)p;
+#endif
+		}
+
+		constexpr bool is_constant_evaluated() noexcept {
+#ifdef __cpp_lib_is_constant_evaluated
+			return std::is_constant_evaluated();
+#else
+			return false;
+#endif
+		}
+
+		// The standard traits compare characters by value, so strings of such characters are equal exactly when their bytes are
+		// Custom traits, like case-insensitive ones, may consider different characters equal, and always take the generic path
+		template<typename CharT, typename Traits>
+		inline constexpr bool has_standard_traits_v = std::is_same_v<Traits, std::char_traits<CharT>> && std::has_unique_object_representations_v<CharT>;
+
+		template<typename Traits, typename CharT>
+		constexpr bool equal_characters(CharT const* lhs, CharT const* rhs, std::size_t size) noexcept {
+			if constexpr(has_standard_traits_v<CharT, Traits>) {
+				if(!is_constant_evaluated()) {
+					return size == 0 || std::memcmp(lhs, rhs, size * sizeof(CharT)) == 0;
+				}
+			}
+			return Traits::compare(lhs, rhs, size) == 0;
+		}
+
+		template<typename Allocator, typename T, typename = void>
+		struct has_construct : std::false_type {};
+		template<typename Allocator, typename T>
+		struct has_construct<Allocator, T, std::void_t<decltype(std::declval<Allocator&>().construct(std::declval<T*>(), std::declval<T const&>()))>> : std::true_type {};
+
+		// Whether constructing characters with the allocator is the same as copying their bytes
+		template<typename Allocator, typename CharT>
+		inline constexpr bool constructs_by_copy_v = std::is_trivially_copyable_v<CharT>
+			&& (std::is_same_v<Allocator, std::allocator<CharT>> || !has_construct<Allocator, CharT>::value);
+
+		// Copies count characters to uninitialized storage, with memcpy if the allocator does not customize construction
+		template<typename Allocator, typename CharT>
+		void construct_characters(Allocator& alloc, CharT* dest, CharT const* src, std::size_t count) {
+			if constexpr(constructs_by_copy_v<Allocator, CharT>) {
+				if(count != 0) {
+					std::memcpy(dest, src, count * sizeof(CharT));
+				}
+			} else {
+				// If a construction throws, the characters constructed so far are destroyed
+				std::size_t i = 0;
+				try {
+					for(; i < count; ++i) {
+						std::allocator_traits<Allocator>::construct(alloc, dest + i, src[i]);
+					}
+				} catch(...) {
+					while(i != 0) {
+						std::allocator_traits<Allocator>::destroy(alloc, dest + --i);
+					}
+					throw;
+				}
+			}
+		}
+
+		// FNV-1a over the character values
+		template<typename Traits, typename CharT>
+		constexpr auto hash_characters(CharT const* str, std::size_t size) noexcept -> std::size_t {
+			std::uint64_t hash = 14695981039346656037ull;
+			for(std::size_t i = 0; i < size; ++i) {
+				hash ^= static_cast<std::uint64_t>(Traits::to_int_type(str[i]));
+				hash *= 1099511628211ull;
+			}
+			return static_cast<std::size_t>(hash);
+		}
 	}
 
 	template<
@@ -39,7 +158,7 @@ namespace kab
 		using mutable_pointer = typename alloc_traits::pointer;
 	public:
 		basic_shared_string() = default;
-		template<typename T>
+		template<typename T, typename = std::enable_if_t<std::is_convertible_v<T const&, string_view>>>
 		explicit basic_shared_string(T const& t, Allocator const& alloc = Allocator()) 
 			: Allocator(alloc)
 			, control(make_control(t, access_allocator()))
@@ -47,16 +166,23 @@ namespace kab
 			, value_end(value_begin + string_view(t).size()) {
 
 		}
-		basic_shared_string(basic_shared_string const& other)
+		basic_shared_string(typename alloc_traits::size_type count, CharT ch, Allocator const& alloc = Allocator())
+			: Allocator(alloc)
+			, control(make_control(count, ch, access_allocator()))
+			, value_begin(get_data(control))
+			, value_end(value_begin + count) {
+
+		}
+		constexpr basic_shared_string(basic_shared_string const& other)
 			: Allocator(alloc_traits::select_on_container_copy_construction(other.access_allocator()))
-			, control(alloc_traits::is_always_equal::value || access_allocator() == other.access_allocator() 
+			, control(alloc_traits::is_always_equal::value || !other.control || access_allocator() == other.access_allocator()
 				? acquire_if_valid(other.control)
-				: make_control({other.value_begin, other.size()}, access_allocator()))
-			, value_begin(control != nullptr ? get_data(control) : other.value_begin)
+				: make_control(other.view(), access_allocator()))
+			, value_begin(control == other.control ? other.value_begin : get_data(control))
 			, value_end(value_begin + other.size()) {
 
 		}
-		basic_shared_string(basic_shared_string && other) noexcept
+		constexpr basic_shared_string(basic_shared_string && other) noexcept
 			: Allocator(std::move(other.access_allocator()))
 			, control(std::exchange(other.control, byte_pointer()))
 			, value_begin(std::exchange(other.value_begin, pointer()))
@@ -65,42 +191,41 @@ namespace kab
 		}
 		auto operator=(basic_shared_string const& other) -> basic_shared_string& {
 			if(this != &other) {
-				release_current_control_if_valid();
 				// If the allocators are equal, just take the value
 				if(alloc_traits::is_always_equal::value || access_allocator() == other.access_allocator()) {
+					release_current_control_if_valid();
 					control = acquire_if_valid(other.control);
 					value_begin = other.value_begin;
 					value_end = other.value_end;
 				// If the allocators are unequal, but can propagate on copy assignement, then propagate then take the value
 				} else if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+					release_current_control_if_valid();
 					access_allocator() = other.access_allocator();
 					control = acquire_if_valid(other.control);
 					value_begin = other.value_begin;
 					value_end = other.value_end;
 				} else {
-					control = make_control({ other.data(), other.size() }, access_allocator());
-					value_begin = get_data(control) + other.get_start_offset();
-					value_end = value_begin + other.size();
+					assign_copy(other);
 				}
 			}
 			return *this;
 		}
-		auto operator=(basic_shared_string && other) -> basic_shared_string & {
+		auto operator=(basic_shared_string && other) 
+			noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) -> basic_shared_string & {
 			if(this != &other) {
-				release_current_control_if_valid();
 				if(alloc_traits::is_always_equal::value || access_allocator() == other.access_allocator()) {
+					release_current_control_if_valid();
 					control = std::exchange(other.control, byte_pointer());
 					value_begin = other.value_begin;
 					value_end = other.value_end;
 				} else if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+					release_current_control_if_valid();
 					access_allocator() = std::move(other).access_allocator();
 					control = std::exchange(other.control, byte_pointer());
 					value_begin = other.value_begin;
 					value_end = other.value_end;
 				} else {
-					control = make_control({ other.data(), other.size() }, access_allocator());
-					value_begin = get_data(control) + other.get_start_offset();
-					value_end = value_begin + other.size();
+					assign_copy(other);
 				}
 			}
 			return *this;
@@ -112,8 +237,18 @@ namespace kab
 			value_end = value_begin + sv.size();
 			return *this;
 		}
-		~basic_shared_string() {
-			release_current_control_if_valid();
+		// Destroying a literal touches nothing, so literals can be constants
+		SHARED_STRING_CONSTEXPR20 ~basic_shared_string() {
+			if(control) {
+				release_control(control, access_allocator());
+			}
+		}
+
+		// Makes a string of characters with static storage duration, which is immortal like a literal: it has no control block,
+		// so copies and substrings never write a reference count, and a constant string is entirely in read-only memory
+		// Requires: the characters outlive every string sharing them
+		static constexpr auto from_static(string_view value) noexcept -> basic_shared_string {
+			return basic_shared_string(literal_tag, value.data(), value.size());
 		}
 
 		void swap(basic_shared_string& other) 
@@ -147,31 +282,48 @@ namespace kab
 		using pointer = typename alloc_traits::const_pointer;
 		using const_pointer = typename alloc_traits::const_pointer;
 
-		auto operator[](size_type index) const -> reference {
+		// Strings are contiguous, so plain pointers are their iterators
+		using iterator = value_type const*;
+		using const_iterator = iterator;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = reverse_iterator;
+
+		static constexpr size_type npos = size_type(-1);
+
+		constexpr auto begin() const noexcept -> const_iterator { return data(); }
+		constexpr auto end() const noexcept -> const_iterator { return data() + size(); }
+		constexpr auto cbegin() const noexcept -> const_iterator { return begin(); }
+		constexpr auto cend() const noexcept -> const_iterator { return end(); }
+		constexpr auto rbegin() const noexcept -> const_reverse_iterator { return const_reverse_iterator(end()); }
+		constexpr auto rend() const noexcept -> const_reverse_iterator { return const_reverse_iterator(begin()); }
+		constexpr auto crbegin() const noexcept -> const_reverse_iterator { return rbegin(); }
+		constexpr auto crend() const noexcept -> const_reverse_iterator { return rend(); }
+
+		constexpr auto operator[](size_type index) const -> reference {
 			return value_begin[index];
 		}
-		auto at(size_type index) const -> reference {
+		constexpr auto at(size_type index) const -> reference {
 			if(index >= size()) {
 				throw std::out_of_range("Index out of range in basic_shared_string");
 			}
 			return value_begin[index];
 		}
-		auto front() const -> reference {
+		constexpr auto front() const -> reference {
 			return value_begin[0];
 		}
-		auto back() const -> reference {
+		constexpr auto back() const -> reference {
 			return *(value_end - 1);
 		}
-		auto data() const noexcept -> value_type const* {
+		constexpr auto data() const noexcept -> value_type const* {
 			return value_begin;
 		}
-		auto size() const noexcept -> size_type {
+		constexpr auto size() const noexcept -> size_type {
 			return std::distance(value_begin, value_end);
 		}
 		constexpr auto max_size() const noexcept -> size_type {
 			return alloc_traits::max_size();
 		}
-		[[nodiscard]] bool empty() const noexcept {
+		[[nodiscard]] constexpr bool empty() const noexcept {
 			return value_begin == value_end;
 		}
 		void clear() noexcept { 
@@ -180,23 +332,144 @@ namespace kab
 			value_begin = value_end = pointer();
 		}
 
+		// The result shares ownership with this string, unless the copy of the allocator is not equal
+		auto substr(size_type pos = 0, size_type count = npos) const -> basic_shared_string {
+			if(pos > size()) {
+				throw std::out_of_range("Position out of range in basic_shared_string::substr");
+			}
+			basic_shared_string result(*this);
+			result.value_begin += pos;
+			result.value_end = result.value_begin + (std::min)(count, size() - pos);
+			return result;
+		}
+
+		// Shares ownership of a view of this string's storage, like one returned by an API working on string_views
+		// The view may reach outside of this string, but not outside of the block it shares as given by block_size, which is checked
+		auto share(string_view view) const -> basic_shared_string {
+			if(view.empty()) {
+				return basic_shared_string(adopt_tag, access_allocator(), byte_pointer(), pointer(), pointer());
+			}
+			// A default constructed string has no storage at all, so no view is inside of it
+			bool inside = false;
+			if(control || value_begin != pointer()) {
+				CharT const* const block_begin = control ? std::addressof(*get_data(control)) : std::addressof(*value_begin);
+				CharT const* const block_end = block_begin + block_size();
+				std::less_equal<CharT const*> const before;
+				inside = before(block_begin, view.data()) && before(view.data() + view.size(), block_end);
+			}
+			if(!inside) {
+				throw std::out_of_range("View outside of the storage in basic_shared_string::share");
+			}
+			return basic_shared_string(adopt_tag, access_allocator(), acquire_if_valid(control), view.data(), view.data() + view.size());
+		}
+		// Position of the first character of this string in the storage it shares
+		auto offset_in_block() const noexcept -> size_type {
+			return control ? get_start_offset() : 0;
+		}
+		// Number of characters in the storage this string shares, and keeps alive. Literals share no storage but their own characters
+		// While the owner of the block may still write to it, only the characters up to the end of this string are known to be written
+		auto block_size() const noexcept -> size_type {
+			if(!control) {
+				return size();
+			}
+			if(get_header(control).flags.load(std::memory_order_acquire) & detail::block_writable) {
+				return get_start_offset() + size();
+			}
+			return get_block_size(control);
+		}
+		// Number of strings sharing ownership of this string's block, 0 for literals
+		// It is read without synchronization, so it is only a hint while other threads copy or release those strings
+		auto use_count() const noexcept -> std::size_t {
+			return control ? get_refcount(control).load(std::memory_order_relaxed) : 0;
+		}
+		// Number of bytes of the allocation this string keeps alive, header included. Literals keep no allocation alive
+		auto block_bytes() const noexcept -> std::size_t {
+			return control ? get_allocation_size(get_block_size(control)) : 0;
+		}
+
+		constexpr auto view() const noexcept -> string_view {
+			return string_view(data(), size());
+		}
+		constexpr operator string_view() const noexcept {
+			return view();
+		}
+
+		constexpr auto compare(basic_shared_string const& other) const noexcept -> int {
+			return view().compare(other.view());
+		}
+		constexpr auto compare(string_view other) const noexcept -> int {
+			return view().compare(other);
+		}
+
+		constexpr auto find(string_view value, size_type pos = 0) const noexcept -> size_type {
+			return view().find(value, pos);
+		}
+		constexpr auto find(CharT ch, size_type pos = 0) const noexcept -> size_type {
+			return view().find(ch, pos);
+		}
+
+		// Strings sharing the same view of the same storage are equal without looking at the characters
+		// Constant evaluation cannot compare the addresses of different literals, so it always looks at the characters
+		friend constexpr bool operator==(basic_shared_string const& lhs, basic_shared_string const& rhs) noexcept {
+			if(detail::is_constant_evaluated()) {
+				return lhs.compare(rhs) == 0;
+			}
+			return lhs.size() == rhs.size() && (lhs.data() == rhs.data() || detail::equal_characters<Traits>(lhs.data(), rhs.data(), lhs.size()));
+		}
+		friend constexpr bool operator!=(basic_shared_string const& lhs, basic_shared_string const& rhs) noexcept {
+			return !(lhs == rhs);
+		}
+		friend constexpr bool operator<(basic_shared_string const& lhs, basic_shared_string const& rhs) noexcept {
+			return lhs.compare(rhs) < 0;
+		}
+		friend constexpr bool operator>(basic_shared_string const& lhs, basic_shared_string const& rhs) noexcept {
+			return lhs.compare(rhs) > 0;
+		}
+		friend constexpr bool operator<=(basic_shared_string const& lhs, basic_shared_string const& rhs) noexcept {
+			return lhs.compare(rhs) <= 0;
+		}
+		friend constexpr bool operator>=(basic_shared_string const& lhs, basic_shared_string const& rhs) noexcept {
+			return lhs.compare(rhs) >= 0;
+		}
+
 	private:
-		auto access_allocator() & noexcept -> Allocator & { return *this; }
-		auto access_allocator() && noexcept -> Allocator && { return std::move(*this); }
-		auto access_allocator() const& noexcept -> Allocator const& { return *this; }
+		constexpr auto access_allocator() & noexcept -> Allocator & { return *this; }
+		constexpr auto access_allocator() && noexcept -> Allocator && { return std::move(*this); }
+		constexpr auto access_allocator() const& noexcept -> Allocator const& { return *this; }
 
 		using byte_pointer = typename bytes_alloc_traits::pointer;
 
-		static auto get_refcount(byte_pointer p) -> std::atomic_size_t & { return *reinterpret_cast<std::atomic_size_t*>(p); }
-		static auto get_data(byte_pointer p) -> mutable_pointer { return reinterpret_cast<CharT*>(p + sizeof(std::atomic_size_t)); }
-		
-		static auto make_control(string_view sv, allocator_type& alloc) -> byte_pointer {
+		// Every block starts with its reference count, the number of characters it holds, and the flags caching properties
+		// of the characters, followed by the characters
+		struct control_header {
+			std::atomic_size_t refcount;
+			size_type size;
+			std::atomic<unsigned> flags;
+		};
+		static constexpr std::size_t header_size = (sizeof(control_header) + alignof(CharT) - 1) / alignof(CharT) * alignof(CharT);
+
+		static auto get_header(byte_pointer p) -> control_header & { return *reinterpret_cast<control_header*>(std::addressof(*p)); }
+		static auto get_refcount(byte_pointer p) -> std::atomic_size_t & { return get_header(p).refcount; }
+		static auto get_block_size(byte_pointer p) -> size_type { return get_header(p).size; }
+		static auto get_data(byte_pointer p) -> mutable_pointer { return reinterpret_cast<CharT*>(p + header_size); }
+		static auto get_allocation_size(size_type size) noexcept -> std::size_t { return header_size + sizeof(CharT) * size; }
+
+		static auto allocate_control(size_type size, allocator_type& alloc) -> byte_pointer {
 			bytes_alloc b_alloc(alloc);
-			auto const block = bytes_alloc_traits::allocate(b_alloc, sizeof(std::atomic_size_t) + sizeof(CharT) * sv.size());
-			new(&get_refcount(block)) std::atomic_size_t{ 1 };
+			auto const block = bytes_alloc_traits::allocate(b_alloc, get_allocation_size(size));
+			new(&get_header(block)) control_header{ { 1 }, size, { 0 } };
+			return block;
+		}
+		static auto make_control(string_view sv, allocator_type& alloc) -> byte_pointer {
+			auto const block = allocate_control(sv.size(), alloc);
+			detail::construct_characters(alloc, std::addressof(*get_data(block)), sv.data(), sv.size());
+			return block;
+		}
+		static auto make_control(size_type count, CharT ch, allocator_type& alloc) -> byte_pointer {
+			auto const block = allocate_control(count, alloc);
 			auto const string = get_data(block);
-			for (size_type i = 0; i < sv.size(); ++i) {
-				alloc_traits::construct(alloc, std::addressof(*string) + i, sv[i]);
+			for (size_type i = 0; i < count; ++i) {
+				alloc_traits::construct(alloc, std::addressof(*string) + i, ch);
 			}
 			return block;
 		}
@@ -204,47 +477,77 @@ namespace kab
 			get_refcount(p).fetch_add(1, std::memory_order_relaxed);
 			return p;
 		}
-		static byte_pointer acquire_if_valid(byte_pointer p) noexcept {
+		static constexpr byte_pointer acquire_if_valid(byte_pointer p) noexcept {
 			return p != nullptr ? acquire_control(p) : nullptr;
 		}
-		static void release_control(byte_pointer p, size_type size, allocator_type& alloc) noexcept {
+		static void release_control(byte_pointer p, allocator_type& alloc) noexcept {
 			if(get_refcount(p).fetch_sub(1, std::memory_order_release) == 1) {
 				std::atomic_thread_fence(std::memory_order_acquire);
-				free_control(p, size, alloc);
+				free_control(p, alloc);
 			}
 		}
-		static void free_control(byte_pointer p, size_type size, allocator_type& alloc) noexcept {
+		static void free_control(byte_pointer p, allocator_type& alloc) noexcept {
+			size_type const size = get_block_size(p);
 			mutable_pointer const value = get_data(p);
 			for (size_type i = 0; i < size; ++i) {
 				alloc_traits::destroy(alloc, std::addressof(*value) + i);
 			}
+			deallocate_control(p, alloc);
+		}
+		// Requires: the characters of the block were destroyed, or never constructed
+		static void deallocate_control(byte_pointer p, allocator_type& alloc) noexcept {
+			size_type const size = get_block_size(p);
+			get_header(p).~control_header();
 			bytes_alloc b_alloc(alloc);			
-			bytes_alloc_traits::deallocate(b_alloc, p, sizeof(std::atomic_size_t) + size);
+			bytes_alloc_traits::deallocate(b_alloc, p, get_allocation_size(size));
 		}
 		void release_current_control_if_valid() noexcept {
 			if(control) {
-				release_control(control, size(), access_allocator());
+				release_control(control, access_allocator());
 			}
 		}
 
+		// Copies only the characters other views, not the rest of its block, into storage from this string's allocator
+		// Literals are never copied, since they do not belong to any allocator
+		void assign_copy(basic_shared_string const& other) {
+			byte_pointer const new_control = other.control ? make_control(other.view(), access_allocator()) : byte_pointer();
+			release_current_control_if_valid();
+			control = new_control;
+			value_begin = control ? pointer(get_data(control)) : other.value_begin;
+			value_end = value_begin + other.size();
+		}
+
 		// If substr'd, a string may point to a value further down the owned data
 		auto get_start_offset() const noexcept -> size_type {
 			return std::distance<pointer>(get_data(control), value_begin);
 		}
 
-		friend auto literals::operator""_ss(char const*, std::size_t) -> basic_shared_string<char>;
-		friend auto literals::operator""_ss(wchar_t const*, std::size_t) -> basic_shared_string<wchar_t>;
-		friend auto literals::operator""_ss(char16_t const*, std::size_t)->basic_shared_string<char16_t>;
-		friend auto literals::operator""_ss(char32_t const*, std::size_t)->basic_shared_string<char32_t>;
+		// GCC rejects befriending a qualified literal operator, so the literals go through this instead
+		friend struct detail::literal_access;
 
 		struct literal_tag_t {};
 		inline constexpr static literal_tag_t literal_tag = {};
-		basic_shared_string(literal_tag_t, CharT const* str, std::size_t size)
+		constexpr basic_shared_string(literal_tag_t, CharT const* str, std::size_t size)
 			: value_begin(str)
 			, value_end(value_begin + size) {
 
 		}
 
+		friend struct detail::bulk_access;
+		friend struct detail::flags_access;
+		friend class basic_shared_string_ref<CharT, Traits, Allocator>;
+
+		// Takes over one of the references already counted in the control block
+		struct adopt_tag_t {};
+		inline constexpr static adopt_tag_t adopt_tag = {};
+		basic_shared_string(adopt_tag_t, Allocator const& alloc, byte_pointer control, pointer begin, pointer end) noexcept
+			: Allocator(alloc)
+			, control(control)
+			, value_begin(begin)
+			, value_end(end) {
+
+		}
+
 		byte_pointer control = byte_pointer();
 		pointer value_begin = pointer();
 		pointer value_end = pointer();
@@ -255,18 +558,498 @@ namespace kab
 	using shared_u16string = basic_shared_string<char16_t>;
 	using shared_u32string = basic_shared_string<char32_t>;
 
+	// What operator""_ss makes: a string literal along with the hash of its characters, computed at compile time where possible
+	// It converts to the basic_shared_string literal it names, and cannot be changed, so its hash always matches its characters
+	template<typename CharT>
+	class basic_literal_key {
+	public:
+		constexpr auto data() const noexcept -> CharT const* { return str; }
+		constexpr auto size() const noexcept -> std::size_t { return length; }
+		constexpr auto view() const noexcept -> std::basic_string_view<CharT> { return std::basic_string_view<CharT>(str, length); }
+		// Same value as std::hash of the equal basic_shared_string
+		constexpr auto hash() const noexcept -> std::size_t { return precomputed_hash; }
+
+		SHARED_STRING_CONSTEXPR20 operator basic_shared_string<CharT>() const noexcept {
+			return basic_shared_string<CharT>::from_static(view());
+		}
+
+	private:
+		friend struct detail::literal_access;
+
+		constexpr basic_literal_key(CharT const* str, std::size_t size, std::size_t hash) noexcept
+			: str(str)
+			, length(size)
+			, precomputed_hash(hash) {
+
+		}
+
+		CharT const* str;
+		std::size_t length;
+		std::size_t precomputed_hash;
+	};
+
+	using literal_key = basic_literal_key<char>;
+	using literal_wkey = basic_literal_key<wchar_t>;
+	using literal_u16key = basic_literal_key<char16_t>;
+	using literal_u32key = basic_literal_key<char32_t>;
+
+	// Transparent hash for unordered containers of strings, equal to std::hash, which lets them look up string views
+	// without making a string from them. Such lookups also need a transparent equality, like std::equal_to<>
+	// Looking up a literal key takes the hash it carries, without hashing its characters
+	struct shared_string_hash {
+		using is_transparent = void;
+
+		template<typename CharT, typename Allocator>
+		constexpr auto operator()(basic_shared_string<CharT, std::char_traits<CharT>, Allocator> const& s) const noexcept -> std::size_t {
+			return detail::hash_characters<std::char_traits<CharT>>(s.data(), s.size());
+		}
+		template<typename CharT>
+		constexpr auto operator()(std::basic_string_view<CharT> s) const noexcept -> std::size_t {
+			return detail::hash_characters<std::char_traits<CharT>>(s.data(), s.size());
+		}
+		template<typename CharT>
+		constexpr auto operator()(basic_literal_key<CharT> const& key) const noexcept -> std::size_t {
+			return key.hash();
+		}
+	};
+
+	// Borrowed view of a basic_shared_string, which keeps enough of it to share ownership of its value later
+	// Making, copying, and narrowing a reference never touches the reference count, so it is the cheap way to pass a string to
+	// a function which only stores it on some paths: the function calls to_shared on the paths where it needs ownership
+	// Like a string_view, the reference must not outlive the string it was made from
+	template<
+		typename CharT,
+		typename Traits /*= std::char_traits<CharT>*/,
+		typename Allocator /*= std::allocator<CharT>*/
+	> class basic_shared_string_ref {
+		using string_type = basic_shared_string<CharT, Traits, Allocator>;
+		using string_view = std::basic_string_view<CharT, Traits>;
+	public:
+		using traits_type = Traits;
+		using value_type = CharT;
+		using allocator_type = Allocator;
+		using size_type = typename string_type::size_type;
+		using pointer = typename string_type::pointer;
+		using const_reference = typename string_type::const_reference;
+
+		using iterator = typename string_type::iterator;
+		using const_iterator = iterator;
+
+		static constexpr size_type npos = string_type::npos;
+
+		basic_shared_string_ref(string_type const& s) noexcept
+			: alloc(std::addressof(s.access_allocator()))
+			, control(s.control)
+			, value_begin(s.value_begin)
+			, value_end(s.value_end) {
+
+		}
+
+		// Shares ownership of the referred value, with a copy of the referred string's allocator
+		auto to_shared() const -> string_type {
+			return string_type(string_type::adopt_tag, *alloc, string_type::acquire_if_valid(control), value_begin, value_end);
+		}
+
+		auto substr(size_type pos = 0, size_type count = npos) const -> basic_shared_string_ref {
+			if(pos > size()) {
+				throw std::out_of_range("Position out of range in basic_shared_string_ref::substr");
+			}
+			basic_shared_string_ref result(*this);
+			result.value_begin += pos;
+			result.value_end = result.value_begin + (std::min)(count, size() - pos);
+			return result;
+		}
+
+		auto operator[](size_type index) const -> const_reference {
+			return value_begin[index];
+		}
+		auto data() const noexcept -> value_type const* {
+			return value_begin;
+		}
+		auto size() const noexcept -> size_type {
+			return std::distance(value_begin, value_end);
+		}
+		[[nodiscard]] bool empty() const noexcept {
+			return value_begin == value_end;
+		}
+		auto view() const noexcept -> string_view {
+			return string_view(data(), size());
+		}
+		operator string_view() const noexcept {
+			return view();
+		}
+		auto begin() const noexcept -> const_iterator { return data(); }
+		auto end() const noexcept -> const_iterator { return data() + size(); }
+
+		friend bool operator==(basic_shared_string_ref const& lhs, basic_shared_string_ref const& rhs) noexcept {
+			return lhs.size() == rhs.size() && (lhs.data() == rhs.data() || lhs.view() == rhs.view());
+		}
+		friend bool operator!=(basic_shared_string_ref const& lhs, basic_shared_string_ref const& rhs) noexcept {
+			return !(lhs == rhs);
+		}
+
+	private:
+		Allocator const* alloc;
+		typename string_type::byte_pointer control;
+		pointer value_begin;
+		pointer value_end;
+	};
+
+	using shared_string_ref = basic_shared_string_ref<char>;
+	using shared_wstring_ref = basic_shared_string_ref<wchar_t>;
+	using shared_u16string_ref = basic_shared_string_ref<char16_t>;
+	using shared_u32string_ref = basic_shared_string_ref<char32_t>;
+
+	// Whether an object of type T can be moved to new storage by copying its bytes, leaving the old storage without destroying it
+	// Containers like small_vector use it to grow with memcpy. Specialize it for types which are relocatable without being trivially copyable
+	template<typename T>
+	struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+	template<typename T>
+	inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+	// Stateless, even where its copy constructor is user-provided
+	template<typename T>
+	struct is_trivially_relocatable<std::allocator<T>> : std::true_type {};
+
+	// A string is its allocator and three pointers, none of which refers to the string itself
+	template<typename CharT, typename Traits, typename Allocator>
+	struct is_trivially_relocatable<basic_shared_string<CharT, Traits, Allocator>> : std::conjunction<
+		is_trivially_relocatable<Allocator>,
+		is_trivially_relocatable<typename std::allocator_traits<Allocator>::pointer>
+	> {};
+
+	namespace detail {
+		struct literal_access {
+			template<typename CharT>
+			static SHARED_STRING_CONSTEXPR20 auto make(CharT const* str, std::size_t size) -> basic_shared_string<CharT> {
+				return basic_shared_string<CharT>(basic_shared_string<CharT>::literal_tag, str, size);
+			}
+			template<typename CharT>
+			static constexpr auto make_key(CharT const* str, std::size_t size, std::size_t hash) noexcept -> basic_literal_key<CharT> {
+				return basic_literal_key<CharT>(str, size, hash);
+			}
+		};
+
+#if __cpp_nontype_template_args >= 201911L
+		// Holds a string literal as a template argument, so that it can be hashed and concatenated in constant expressions
+		template<typename CharT, std::size_t N>
+		struct fixed_string {
+			constexpr fixed_string() noexcept = default;
+			constexpr fixed_string(CharT const (&str)[N]) noexcept {
+				std::char_traits<CharT>::copy(chars, str, N);
+			}
+
+			CharT chars[N] = {};
+		};
+#endif
+
+		struct flags_access {
+			// The cached flags of the block the string views entirely, or nullptr for a literal or a string viewing part of a block,
+			// whose properties may differ from those of the whole block
+			template<typename String>
+			static auto get(String const& s) noexcept -> std::atomic<unsigned>* {
+				if(!s.control || s.get_start_offset() != 0 || s.size() != String::get_block_size(s.control)) {
+					return nullptr;
+				}
+				return get_if_sealed(String::get_header(s.control).flags);
+			}
+			// The cached flags of the block the string views part or all of, or nullptr for a literal
+			// Both are also nullptr for a block still being written, whose properties may change
+			template<typename String>
+			static auto get_block(String const& s) noexcept -> std::atomic<unsigned>* {
+				return s.control ? get_if_sealed(String::get_header(s.control).flags) : nullptr;
+			}
+
+		private:
+			static auto get_if_sealed(std::atomic<unsigned>& flags) noexcept -> std::atomic<unsigned>* {
+				return (flags.load(std::memory_order_acquire) & block_writable) == 0 ? &flags : nullptr;
+			}
+		};
+
+		struct bulk_access {
+			template<typename String, typename ForwardIt>
+			static auto make(ForwardIt first, ForwardIt last, typename String::allocator_type alloc) -> std::vector<String> {
+				using string_view = std::basic_string_view<typename String::value_type, typename String::traits_type>;
+
+				std::size_t total_size = 0;
+				std::size_t count = 0;
+				for(auto it = first; it != last; ++it, ++count) {
+					total_size += string_view(*it).size();
+				}
+
+				std::vector<String> strings;
+				if(count == 0) {
+					return strings;
+				}
+				strings.reserve(count);
+
+				// Every character is constructed before any string owns the block, so a throwing construction only has to free it
+				auto const block = String::allocate_control(total_size, alloc);
+				auto const data = String::get_data(block);
+				std::size_t constructed = 0;
+				try {
+					for(auto it = first; it != last; ++it) {
+						string_view const value(*it);
+						detail::construct_characters(alloc, std::addressof(*data) + constructed, value.data(), value.size());
+						constructed += value.size();
+					}
+				} catch(...) {
+					for(std::size_t i = 0; i < constructed; ++i) {
+						std::allocator_traits<typename String::allocator_type>::destroy(alloc, std::addressof(*data) + i);
+					}
+					String::deallocate_control(block, alloc);
+					throw;
+				}
+
+				// Every string owns one of the references the block starts with. The strings were reserved, so adding them does not throw
+				String::get_refcount(block).store(count, std::memory_order_relaxed);
+				std::size_t offset = 0;
+				for(auto it = first; it != last; ++it) {
+					std::size_t const size = string_view(*it).size();
+					strings.push_back(String(String::adopt_tag, alloc, block, data + offset, data + offset + size));
+					offset += size;
+				}
+				return strings;
+			}
+
+			// A string of size characters in a new block of exactly that size, written by write(pointer) before any string views them
+			// Requires: the characters are trivial, and write does not throw
+			template<typename String, typename Write>
+			static auto make_written(std::size_t size, typename String::allocator_type alloc, Write&& write) -> String {
+				static_assert(std::is_trivial_v<typename String::value_type>, "The characters are written without being constructed");
+				if(size == 0) {
+					return String(String::adopt_tag, alloc, {}, nullptr, nullptr);
+				}
+				auto const block = String::allocate_control(size, alloc);
+				auto const data = String::get_data(block);
+				write(std::addressof(*data));
+				return String(String::adopt_tag, alloc, block, data, data + size);
+			}
+
+			// A new block of size characters, with the only pointer through which they can be written, for an owner filling it over time
+			// Until it is sealed, strings sharing the block only reach up to their own end, through share and block_size
+			// Requires: the characters are trivial, the owner writes them from the front and only hands out strings over written ones,
+			// and seals the block when done
+			template<typename String>
+			static auto make_writable(std::size_t size, typename String::allocator_type alloc) -> std::pair<String, typename String::value_type*> {
+				static_assert(std::is_trivial_v<typename String::value_type>, "The characters are written without being constructed");
+				auto const block = String::allocate_control(size, alloc);
+				String::get_header(block).flags.store(block_writable, std::memory_order_relaxed);
+				auto const data = String::get_data(block);
+				return { String(String::adopt_tag, alloc, block, data, data + size), std::addressof(*data) };
+			}
+			// Once its owner is done writing to a block made by make_writable, properties of its characters may be cached
+			// The characters past the written ones are value initialized first, since strings sharing the block can then reach all of them
+			template<typename String>
+			static void seal(String const& block, std::size_t written) noexcept {
+				auto const data = std::addressof(*String::get_data(block.control));
+				std::fill(data + written, data + String::get_block_size(block.control), typename String::value_type());
+				String::get_header(block.control).flags.fetch_and(~unsigned(block_writable), std::memory_order_release);
+			}
+
+			template<typename String, typename OutputIt>
+			static auto share(String const& value, std::size_t count, OutputIt out) -> OutputIt {
+				if(count == 0) {
+					return out;
+				}
+				if(value.control) {
+					String::get_refcount(value.control).fetch_add(count, std::memory_order_relaxed);
+				}
+				// If writing to the output throws, the references not handed out yet are given back
+				std::size_t written = 0;
+				try {
+					while(written < count) {
+						String handle(String::adopt_tag, value.access_allocator(), value.control, value.value_begin, value.value_end);
+						// The handle owns its reference from now on, and gives it back itself if the output throws
+						++written;
+						*out++ = std::move(handle);
+					}
+				} catch(...) {
+					if(value.control) {
+						String::get_refcount(value.control).fetch_sub(count - written, std::memory_order_relaxed);
+					}
+					throw;
+				}
+				return out;
+			}
+
+			template<typename ForwardIt>
+			static void release_shared(ForwardIt first, ForwardIt last) noexcept {
+				using string_type = typename std::iterator_traits<ForwardIt>::value_type;
+				if(first == last) {
+					return;
+				}
+				auto const control = first->control;
+				std::size_t count = 0;
+				for(auto it = first; it != last; ++it, ++count) {
+					assert(it->control == control && "All the strings must share the same control block");
+					it->control = nullptr;
+					it->value_begin = it->value_end = nullptr;
+				}
+				if(control && string_type::get_refcount(control).fetch_sub(count, std::memory_order_release) == count) {
+					std::atomic_thread_fence(std::memory_order_acquire);
+					string_type::free_control(control, first->access_allocator());
+				}
+			}
+
+			template<typename RandomIt>
+			static void release_all(RandomIt first, RandomIt last) {
+				using string_type = typename std::iterator_traits<RandomIt>::value_type;
+				using byte_pointer = typename string_type::byte_pointer;
+
+				// Owned blocks with the position of one of their owners, to find an allocator to free them with
+				std::vector<std::pair<byte_pointer, std::size_t>> controls;
+				controls.reserve(static_cast<std::size_t>(std::distance(first, last)));
+				for(std::size_t i = 0; first + i != last; ++i) {
+					string_type& s = first[i];
+					if(s.control) {
+						controls.emplace_back(s.control, i);
+					}
+					s.control = nullptr;
+					s.value_begin = s.value_end = nullptr;
+				}
+				std::sort(controls.begin(), controls.end());
+
+				for(std::size_t group_begin = 0; group_begin < controls.size();) {
+					byte_pointer const control = controls[group_begin].first;
+					std::size_t group_end = group_begin + 1;
+					while(group_end < controls.size() && controls[group_end].first == control) {
+						++group_end;
+					}
+					if(group_end < controls.size()) {
+						prefetch_for_write(std::addressof(*controls[group_end].first));
+					}
+
+					std::size_t const count = group_end - group_begin;
+					if(string_type::get_refcount(control).fetch_sub(count, std::memory_order_release) == count) {
+						std::atomic_thread_fence(std::memory_order_acquire);
+						string_type::free_control(control, first[controls[group_begin].second].access_allocator());
+					}
+					group_begin = group_end;
+				}
+			}
+		};
+	}
+
+	// Makes a string for every value of the range, all sharing a single control block holding their characters back to back
+	// The block is only freed once every one of the strings, and the strings sharing ownership with them, are gone
+	template<typename String = shared_string, typename ForwardIt>
+	auto make_shared_strings(ForwardIt first, ForwardIt last, typename String::allocator_type const& alloc = typename String::allocator_type()) -> std::vector<String> {
+		return detail::bulk_access::make<String>(first, last, alloc);
+	}
+#ifdef __cpp_lib_span
+	template<typename String = shared_string, typename T, std::size_t Extent>
+	auto make_shared_strings(std::span<T, Extent> values, typename String::allocator_type const& alloc = typename String::allocator_type()) -> std::vector<String> {
+		return detail::bulk_access::make<String>(values.begin(), values.end(), alloc);
+	}
+#endif
+
+	// Writes count strings sharing ownership with value to out, with a single increment of the reference count
+	template<typename CharT, typename Traits, typename Allocator, typename OutputIt>
+	auto share_n(basic_shared_string<CharT, Traits, Allocator> const& value, std::size_t count, OutputIt out) -> OutputIt {
+		return detail::bulk_access::share(value, count, out);
+	}
+
+	// Clears every string of the range with a single decrement of the reference count, like clear on each of them
+	// Requires: every string of the range shares the same control block, as the strings written by share_n
+	template<typename ForwardIt>
+	void release_shared(ForwardIt first, ForwardIt last) noexcept {
+		detail::bulk_access::release_shared(first, last);
+	}
+
+	// Clears every string of the range like clear on each of them, with a single decrement per distinct control block
+	// Meant to tear down large collections of strings sharing few blocks, such as the fields of parsed documents
+	// Requires: the strings sharing a control block have equal allocators
+	template<typename RandomIt>
+	void release_all(RandomIt first, RandomIt last) {
+		detail::bulk_access::release_all(first, last);
+	}
+
+	// Makes an array of immortal strings from string literals, meant for constant lookup tables
+	// constexpr auto status_texts = make_static_strings("OK", "Created", "Accepted");
+	template<typename CharT, std::size_t... N>
+	constexpr auto make_static_strings(CharT const (&... values)[N]) noexcept -> std::array<basic_shared_string<CharT>, sizeof...(N)> {
+		return { basic_shared_string<CharT>::from_static(std::basic_string_view<CharT>(values, N - 1))... };
+	}
+
+#if __cpp_nontype_template_args >= 201911L
+	namespace detail {
+		template<fixed_string First, fixed_string... Rest>
+		constexpr auto concatenate() noexcept {
+			using char_type = std::remove_const_t<std::remove_reference_t<decltype(First.chars[0])>>;
+			static_assert((std::is_same_v<char_type, std::remove_const_t<std::remove_reference_t<decltype(Rest.chars[0])>>> && ...),
+				"Concatenated literals must have the same character type");
+
+			fixed_string<char_type, (std::size(First.chars) - 1) + ((std::size(Rest.chars) - 1) + ... + 1)> result;
+			std::size_t offset = 0;
+			auto const append = [&](auto const& part) {
+				std::size_t const size = std::size(part.chars) - 1;
+				std::char_traits<char_type>::copy(result.chars + offset, part.chars, size);
+				offset += size;
+			};
+			append(First);
+			(append(Rest), ...);
+			return result;
+		}
+
+		template<fixed_string... Strs>
+		inline constexpr auto concatenation = concatenate<Strs...>();
+	}
+
+	// Hash of a string literal computed at compile time, the same value as std::hash of the equal basic_shared_string
+	// Lets code hashing a known key, like a table probed with precomputed hashes, skip hashing it: literal_hash<"content-type">
+	template<detail::fixed_string Str>
+	inline constexpr std::size_t literal_hash = detail::hash_characters<std::char_traits<std::remove_const_t<std::remove_reference_t<decltype(Str.chars[0])>>>>(
+		Str.chars, std::size(Str.chars) - 1);
+
+	// Literal string of the concatenation of string literals, made at compile time in static storage
+	// Like any literal, it has no control block: constexpr auto& key = literal_concat<"svc.", "latency">;
+	template<detail::fixed_string... Strs>
+	inline constexpr auto literal_concat = detail::literal_access::make(detail::concatenation<Strs...>.chars, std::size(detail::concatenation<Strs...>.chars) - 1);
+#endif
+
 	namespace literals {
-		auto operator""_ss(char const* str, std::size_t size) -> shared_string {
-			return shared_string(shared_string::literal_tag, str, size);
+#if __cpp_nontype_template_args >= 201911L
+		// The literal is a template argument, so its hash is computed at compile time
+		template<detail::fixed_string Str>
+		constexpr auto operator""_ss() noexcept {
+			return detail::literal_access::make_key(Str.chars, std::size(Str.chars) - 1, literal_hash<Str>);
+		}
+#else
+		constexpr auto operator""_ss(char const* str, std::size_t size) noexcept -> literal_key {
+			return detail::literal_access::make_key(str, size, detail::hash_characters<std::char_traits<char>>(str, size));
 		}
-		auto operator""_ss(wchar_t const* str, std::size_t size) -> shared_wstring {
-			return shared_wstring(shared_wstring::literal_tag, str, size);
+		constexpr auto operator""_ss(wchar_t const* str, std::size_t size) noexcept -> literal_wkey {
+			return detail::literal_access::make_key(str, size, detail::hash_characters<std::char_traits<wchar_t>>(str, size));
 		}
-		auto operator""_ss(char16_t const* str, std::size_t size) -> shared_u16string {
-			return shared_u16string(shared_u16string::literal_tag, str, size);
+		constexpr auto operator""_ss(char16_t const* str, std::size_t size) noexcept -> literal_u16key {
+			return detail::literal_access::make_key(str, size, detail::hash_characters<std::char_traits<char16_t>>(str, size));
 		}
-		auto operator""_ss(char32_t const* str, std::size_t size) -> shared_u32string {
-			return shared_u32string(shared_u32string::literal_tag, str, size);
+		constexpr auto operator""_ss(char32_t const* str, std::size_t size) noexcept -> literal_u32key {
+			return detail::literal_access::make_key(str, size, detail::hash_characters<std::char_traits<char32_t>>(str, size));
 		}
+#endif
 	}
-}
\ No newline at end of file
+}
+
+namespace std {
+	// Like for basic_string, only provided for the standard character traits
+	template<typename CharT, typename Allocator>
+	struct hash<kab::basic_shared_string<CharT, std::char_traits<CharT>, Allocator>> {
+		constexpr auto operator()(kab::basic_shared_string<CharT, std::char_traits<CharT>, Allocator> const& s) const noexcept -> std::size_t {
+			return kab::detail::hash_characters<std::char_traits<CharT>>(s.data(), s.size());
+		}
+	};
+}
+
+#ifdef __cpp_lib_ranges
+// A reference's iterators point to characters it does not own, so like a string_view's they outlive the reference
+// Those of a string may not outlive a unique owner, so strings are not borrowed ranges
+namespace std::ranges {
+	template<typename CharT, typename Traits, typename Allocator>
+	inline constexpr bool enable_borrowed_range<kab::basic_shared_string_ref<CharT, Traits, Allocator>> = true;
+	template<typename CharT, typename Traits, typename Allocator>
+	inline constexpr bool enable_view<kab::basic_shared_string_ref<CharT, Traits, Allocator>> = true;
+}
+#endif
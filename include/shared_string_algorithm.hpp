@@ -0,0 +1,326 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "shared_string.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <future>
+#include <thread>
+#include <system_error>
+#include <iterator>
+#include <atomic>
+#include <cstddef>
+
+namespace kab
+{
+	namespace detail {
+		template<typename CharT>
+		struct sort_entry {
+			CharT const* data;
+			std::size_t size;
+			std::size_t index; // position of the handle in the input range
+		};
+
+		// The character of a string at the current sort depth. The end of a string orders before any character
+		template<typename CharT>
+		struct sort_key {
+			CharT value;
+			bool end;
+		};
+
+		// Multikey quicksort over the entries, with the characters at the current depth cached in a side array
+		// so that partitioning does not chase the string pointers on every comparison
+		template<typename CharT, typename Traits>
+		class multikey_sorter {
+			using entry = sort_entry<CharT>;
+			using key = sort_key<CharT>;
+			using string_view = std::basic_string_view<CharT, Traits>;
+
+			static constexpr std::size_t insertion_threshold = 16;
+			static constexpr std::size_t parallel_threshold = std::size_t(1) << 14;
+
+		public:
+			multikey_sorter(std::vector<entry>& entries, unsigned max_threads)
+				: entries(entries)
+				, cache(entries.size())
+				, available_threads(max_threads > 1 ? max_threads - 1 : 0) {
+
+			}
+
+			void sort() {
+				sort(0, entries.size(), 0, false);
+			}
+
+		private:
+			static bool key_less(key lhs, key rhs) noexcept {
+				return lhs.end ? !rhs.end : !rhs.end && Traits::lt(lhs.value, rhs.value);
+			}
+			static auto median_of_three(key a, key b, key c) noexcept -> key {
+				if(key_less(a, b)) {
+					return key_less(b, c) ? b : key_less(a, c) ? c : a;
+				} else {
+					return key_less(a, c) ? a : key_less(b, c) ? c : b;
+				}
+			}
+			// Every entry in a range being sorted at some depth has at least that many characters
+			static bool suffix_less(entry const& lhs, entry const& rhs, std::size_t depth) noexcept {
+				return string_view(lhs.data + depth, lhs.size - depth).compare(string_view(rhs.data + depth, rhs.size - depth)) < 0;
+			}
+
+			void fill_cache(std::size_t begin, std::size_t end, std::size_t depth) noexcept {
+				for(std::size_t i = begin; i < end; ++i) {
+					entry const& e = entries[i];
+					cache[i] = depth < e.size ? key{ e.data[depth], false } : key{ CharT(), true };
+				}
+			}
+			void exchange(std::size_t lhs, std::size_t rhs) noexcept {
+				std::swap(entries[lhs], entries[rhs]);
+				std::swap(cache[lhs], cache[rhs]);
+			}
+			void insertion_sort(std::size_t begin, std::size_t end, std::size_t depth) noexcept {
+				for(std::size_t i = begin + 1; i < end; ++i) {
+					entry const current = entries[i];
+					std::size_t j = i;
+					for(; j > begin && suffix_less(current, entries[j - 1], depth); --j) {
+						entries[j] = entries[j - 1];
+					}
+					entries[j] = current;
+				}
+			}
+
+			bool try_acquire_thread() noexcept {
+				unsigned available = available_threads.load(std::memory_order_relaxed);
+				while(available != 0) {
+					if(available_threads.compare_exchange_weak(available, available - 1, std::memory_order_relaxed)) {
+						return true;
+					}
+				}
+				return false;
+			}
+
+			// The ranges given to different threads are disjoint, so they never touch the same entries or cache slots
+			void sort_subrange(std::size_t begin, std::size_t end, std::size_t depth, std::vector<std::future<void>>& tasks) {
+				if(end - begin >= parallel_threshold && try_acquire_thread()) {
+					try {
+						tasks.push_back(std::async(std::launch::async, [this, begin, end, depth] {
+							sort(begin, end, depth, true);
+							available_threads.fetch_add(1, std::memory_order_relaxed);
+						}));
+						return;
+					} catch(std::system_error const&) {
+						available_threads.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+				sort(begin, end, depth, true);
+			}
+
+			void sort(std::size_t begin, std::size_t end, std::size_t depth, bool cached) {
+				std::vector<std::future<void>> tasks;
+				// The equal partition is handled by iteration, since its depth is bounded only by the common prefix length
+				while(end - begin > insertion_threshold) {
+					if(!cached) {
+						fill_cache(begin, end, depth);
+					}
+
+					key const pivot = median_of_three(cache[begin], cache[begin + (end - begin) / 2], cache[end - 1]);
+					std::size_t less_end = begin, i = begin, greater_begin = end;
+					while(i < greater_begin) {
+						if(key_less(cache[i], pivot)) {
+							exchange(less_end++, i++);
+						} else if(key_less(pivot, cache[i])) {
+							exchange(i, --greater_begin);
+						} else {
+							++i;
+						}
+					}
+
+					// The cache of the less and greater partitions still holds the characters at this depth
+					sort_subrange(begin, less_end, depth, tasks);
+					sort_subrange(greater_begin, end, depth, tasks);
+
+					if(pivot.end) {
+						// Every string in the equal partition ended at this depth: they are all equal
+						begin = end;
+						break;
+					}
+					begin = less_end;
+					end = greater_begin;
+					++depth;
+					cached = false;
+				}
+				if(end - begin > 1) {
+					insertion_sort(begin, end, depth);
+				}
+				for(auto& task : tasks) {
+					task.get();
+				}
+			}
+
+			std::vector<entry>& entries;
+			std::vector<key> cache;
+			std::atomic<unsigned> available_threads;
+		};
+
+		inline auto get_thread_count(unsigned max_threads) noexcept -> unsigned {
+			return max_threads != 0 ? max_threads : 1;
+		}
+
+		// Runs the work function on thread_count threads, including the calling one
+		template<typename F>
+		void run_on_threads(unsigned thread_count, F const& work) {
+			std::vector<std::future<void>> tasks;
+			tasks.reserve(thread_count - 1);
+			for(unsigned i = 1; i < thread_count; ++i) {
+				try {
+					tasks.push_back(std::async(std::launch::async, [&work] { work(); }));
+				} catch(std::system_error const&) {
+					break;
+				}
+			}
+			work();
+			for(auto& task : tasks) {
+				task.get();
+			}
+		}
+	}
+
+	// Sorts a range of basic_shared_string in the order of compare, using up to max_threads threads
+	// Only the handles are exchanged through swap: no character is copied, and no reference count is touched
+	// Requires: all the strings in the range have equal allocators, or allocators propagating on swap
+	template<typename RandomIt>
+	void parallel_string_sort(RandomIt first, RandomIt last, unsigned max_threads = std::thread::hardware_concurrency()) {
+		using string_type = typename std::iterator_traits<RandomIt>::value_type;
+		using char_type = typename string_type::value_type;
+		using traits_type = typename string_type::traits_type;
+		using entry = detail::sort_entry<char_type>;
+
+		auto const count = static_cast<std::size_t>(std::distance(first, last));
+		if(count < 2) {
+			return;
+		}
+
+		std::vector<entry> entries;
+		entries.reserve(count);
+		for(std::size_t i = 0; i < count; ++i) {
+			string_type const& s = first[i];
+			entries.push_back(entry{ s.data(), static_cast<std::size_t>(s.size()), i });
+		}
+
+		detail::multikey_sorter<char_type, traits_type>(entries, max_threads).sort();
+
+		// entries[i].index is now the input position of the handle that belongs at i. Follow each cycle of the permutation
+		for(std::size_t i = 0; i < count; ++i) {
+			std::size_t current = i;
+			while(entries[current].index != i) {
+				std::size_t const next = entries[current].index;
+				first[current].swap(first[next]);
+				entries[current].index = current;
+				current = next;
+			}
+			entries[current].index = current;
+		}
+	}
+
+	template<typename RandomIt>
+	void string_sort(RandomIt first, RandomIt last) {
+		parallel_string_sort(first, last, 1);
+	}
+
+	struct dedup_result {
+		std::size_t duplicates = 0; // handles that were made to share the storage of an equal string
+		std::size_t duplicate_bytes = 0; // bytes of the characters those handles viewed
+		// Bytes of the blocks freed by replacing those handles, headers included. A block is only freed by its last owner,
+		// which is told with a relaxed read of its reference count, so owners outside of the range can make this a best effort
+		std::size_t freed_bytes = 0;
+	};
+
+	// Makes every string of the range equal to an earlier one share that earlier string's storage, using up to max_threads threads
+	// The strings are partitioned by hash, and each partition is deduplicated by a single thread
+	// The storage of a replaced string is freed if that handle was its last owner
+	// Requires: all the strings in the range have equal allocators
+	template<typename RandomIt>
+	auto dedup(RandomIt first, RandomIt last, unsigned max_threads = std::thread::hardware_concurrency()) -> dedup_result {
+		using string_type = typename std::iterator_traits<RandomIt>::value_type;
+		using char_type = typename string_type::value_type;
+
+		auto const count = static_cast<std::size_t>(std::distance(first, last));
+		unsigned const thread_count = detail::get_thread_count(max_threads);
+		if(count < 2) {
+			return {};
+		}
+
+		std::vector<std::size_t> hashes(count);
+		std::atomic_size_t next_chunk{ 0 };
+		std::size_t const chunk_size = 4096;
+		detail::run_on_threads(thread_count, [&] {
+			std::hash<string_type> const hasher;
+			for(std::size_t begin; (begin = next_chunk.fetch_add(chunk_size, std::memory_order_relaxed)) < count;) {
+				std::size_t const end = std::min(begin + chunk_size, count);
+				for(std::size_t i = begin; i < end; ++i) {
+					hashes[i] = hasher(first[i]);
+				}
+			}
+		});
+
+		// Counting sort of the indices into partitions, keeping the input order inside each partition
+		std::size_t const partition_count = std::size_t(thread_count) * 8;
+		std::vector<std::size_t> partition_offsets(partition_count + 1);
+		for(std::size_t const hash : hashes) {
+			++partition_offsets[hash % partition_count + 1];
+		}
+		std::partial_sum(partition_offsets.begin(), partition_offsets.end(), partition_offsets.begin());
+		std::vector<std::size_t> indices(count);
+		{
+			std::vector<std::size_t> cursors(partition_offsets.begin(), partition_offsets.end() - 1);
+			for(std::size_t i = 0; i < count; ++i) {
+				indices[cursors[hashes[i] % partition_count]++] = i;
+			}
+		}
+
+		std::atomic_size_t next_partition{ 0 };
+		std::atomic_size_t duplicates{ 0 };
+		std::atomic_size_t duplicate_bytes{ 0 };
+		std::atomic_size_t freed_bytes{ 0 };
+		detail::run_on_threads(thread_count, [&] {
+			dedup_result local;
+			for(std::size_t partition; (partition = next_partition.fetch_add(1, std::memory_order_relaxed)) < partition_count;) {
+				auto const begin = indices.begin() + partition_offsets[partition];
+				auto const end = indices.begin() + partition_offsets[partition + 1];
+				// Stable, so the first string of each value in the range is the one the others share
+				std::stable_sort(begin, end, [&](std::size_t lhs, std::size_t rhs) { return hashes[lhs] < hashes[rhs]; });
+
+				for(auto run_begin = begin; run_begin != end;) {
+					auto const run_end = std::find_if(run_begin, end, [&](std::size_t i) { return hashes[i] != hashes[*run_begin]; });
+					// Inside a run of equal hashes, the unique values are moved to the front of the run
+					auto unique_end = run_begin + 1;
+					for(auto it = run_begin + 1; it != run_end; ++it) {
+						string_type& current = first[*it];
+						auto const original = std::find_if(run_begin, unique_end, [&](std::size_t i) { return first[i] == current; });
+						if(original == unique_end) {
+							std::swap(*unique_end++, *it);
+						} else if(first[*original].data() != current.data()) {
+							++local.duplicates;
+							local.duplicate_bytes += current.size() * sizeof(char_type);
+							if(current.use_count() == 1) {
+								local.freed_bytes += current.block_bytes();
+							}
+							current = first[*original];
+						}
+					}
+					run_begin = run_end;
+				}
+			}
+			duplicates.fetch_add(local.duplicates, std::memory_order_relaxed);
+			duplicate_bytes.fetch_add(local.duplicate_bytes, std::memory_order_relaxed);
+			freed_bytes.fetch_add(local.freed_bytes, std::memory_order_relaxed);
+		});
+
+		return { duplicates.load(), duplicate_bytes.load(), freed_bytes.load() };
+	}
+}
@@ -0,0 +1,118 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "shared_string_column.hpp"
+
+#include <string>
+#include <memory>
+#include <cassert>
+#include <cstdint>
+
+// The structures of the Arrow C Data Interface, as specified by https://arrow.apache.org/docs/format/CDataInterface.html
+// Like the reference header, they use the int64_t of <stdint.h>, which is declared at global scope
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#include <stdint.h>
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+	const char* format;
+	const char* name;
+	const char* metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema** children;
+	struct ArrowSchema* dictionary;
+	void (*release)(struct ArrowSchema*);
+	void* private_data;
+};
+
+struct ArrowArray {
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void** buffers;
+	struct ArrowArray** children;
+	struct ArrowArray* dictionary;
+	void (*release)(struct ArrowArray*);
+	void* private_data;
+};
+
+#endif
+
+namespace kab
+{
+	namespace detail {
+		struct arrow_schema_data {
+			std::string name;
+		};
+
+		inline void release_arrow_schema(ArrowSchema* schema) noexcept {
+			delete static_cast<arrow_schema_data*>(schema->private_data);
+			schema->release = nullptr;
+		}
+
+		// Keeps the exported block and offsets alive until the consumer releases the array
+		template<typename Column>
+		struct arrow_array_data {
+			typename Column::string_type data;
+			std::shared_ptr<std::vector<typename Column::offset_type>> offsets;
+			void const* buffers[3];
+		};
+
+		template<typename Column>
+		void release_arrow_array(ArrowArray* array) noexcept {
+			delete static_cast<arrow_array_data<Column>*>(array->private_data);
+			array->release = nullptr;
+		}
+	}
+
+	// Describes the arrays exported by export_arrow_chunk: non-nullable large UTF-8 strings
+	inline void export_arrow_schema(ArrowSchema* out, char const* name = "") {
+		auto data = std::make_unique<detail::arrow_schema_data>(detail::arrow_schema_data{ name });
+		out->format = "U";
+		out->name = data->name.c_str();
+		out->metadata = nullptr;
+		out->flags = 0;
+		out->n_children = 0;
+		out->children = nullptr;
+		out->dictionary = nullptr;
+		out->release = &detail::release_arrow_schema;
+		out->private_data = data.release();
+	}
+
+	// Exports the rows of a chunk of the column without copying them: the array's buffers are the chunk's offsets
+	// and the characters of its shared block, which the array keeps a reference to until it is released
+	// Rows pushed to the column after the export are not part of the array
+	template<typename Traits, typename Allocator>
+	void export_arrow_chunk(basic_shared_string_column<char, Traits, Allocator> const& column, std::size_t chunk_index, ArrowArray* out) {
+		using column_type = basic_shared_string_column<char, Traits, Allocator>;
+		assert(chunk_index < column.get_chunk_count() && "Chunk index out of range");
+
+		auto c = column.get_chunk(chunk_index);
+		auto data = std::make_unique<detail::arrow_array_data<column_type>>(detail::arrow_array_data<column_type>{ std::move(c.data), std::move(c.offsets), {} });
+		data->buffers[0] = nullptr; // no validity bitmap, since no row is null
+		data->buffers[1] = data->offsets->data();
+		data->buffers[2] = data->data.data();
+
+		out->length = static_cast<std::int64_t>(c.rows);
+		out->null_count = 0;
+		out->offset = 0;
+		out->n_buffers = 3;
+		out->n_children = 0;
+		out->buffers = data->buffers;
+		out->children = nullptr;
+		out->dictionary = nullptr;
+		out->release = &detail::release_arrow_array<column_type>;
+		out->private_data = data.release();
+	}
+}
@@ -0,0 +1,186 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "shared_string.hpp"
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <optional>
+#include <functional>
+#include <atomic>
+#include <stdexcept>
+#include <cstddef>
+
+namespace kab
+{
+	// Thread-safe cache from strings to strings, bounded by the bytes of the blocks its entries keep alive
+	// Entries are spread across shards, each with its own lock, and evicted with the CLOCK policy:
+	// a hit only marks its entry as referenced, so lookups share their shard's lock instead of reordering a list
+	// Hits and evictions never copy characters, they only acquire or release the shared storage
+	template<typename String, typename Hash = std::hash<String>>
+	class basic_shared_string_cache {
+	public:
+		using string_type = String;
+		using size_type = std::size_t;
+
+		// Throws: std::invalid_argument if shard_count is 0
+		explicit basic_shared_string_cache(size_type capacity_bytes, size_type shard_count = 16)
+			: shards(shard_count) {
+			if(shard_count == 0) {
+				throw std::invalid_argument("basic_shared_string_cache needs at least one shard");
+			}
+			for(auto& s : shards) {
+				s = std::make_unique<shard>(capacity_bytes / shard_count);
+			}
+		}
+
+		auto find(string_type const& key) const -> std::optional<string_type> {
+			shard const& s = get_shard(key);
+			std::shared_lock lock(s.mutex);
+			auto const it = s.positions.find(key);
+			if(it == s.positions.end()) {
+				return std::nullopt;
+			}
+			slot const& entry = s.slots[it->second];
+			entry.referenced.store(true, std::memory_order_relaxed);
+			return entry.value;
+		}
+
+		// Returns false if the entry alone is larger than its shard's capacity, in which case it is not inserted
+		bool insert(string_type const& key, string_type const& value) {
+			size_type const charge = get_charge(key) + get_charge(value);
+			shard& s = get_shard(key);
+			if(charge > s.capacity_bytes) {
+				return false;
+			}
+
+			std::unique_lock lock(s.mutex);
+			auto const it = s.positions.find(key);
+			if(it != s.positions.end()) {
+				slot& entry = s.slots[it->second];
+				s.used_bytes -= entry.charge;
+				entry.value = value;
+				entry.charge = charge;
+				entry.referenced.store(true, std::memory_order_relaxed);
+				s.used_bytes += charge;
+				s.evict_until_fits(0, it->second);
+				return true;
+			}
+
+			s.evict_until_fits(charge, s.slots.size());
+			size_type index;
+			if(!s.free_slots.empty()) {
+				index = s.free_slots.back();
+				s.free_slots.pop_back();
+			} else {
+				index = s.slots.size();
+				s.slots.emplace_back();
+			}
+			slot& entry = s.slots[index];
+			entry.key = key;
+			entry.value = value;
+			entry.charge = charge;
+			entry.occupied = true;
+			entry.referenced.store(false, std::memory_order_relaxed);
+			s.positions.emplace(key, index);
+			s.used_bytes += charge;
+			return true;
+		}
+
+		bool erase(string_type const& key) {
+			shard& s = get_shard(key);
+			std::unique_lock lock(s.mutex);
+			auto const it = s.positions.find(key);
+			if(it == s.positions.end()) {
+				return false;
+			}
+			s.evict(it->second);
+			return true;
+		}
+
+		auto used_bytes() const -> size_type {
+			size_type total = 0;
+			for(auto const& s : shards) {
+				std::shared_lock lock(s->mutex);
+				total += s->used_bytes;
+			}
+			return total;
+		}
+
+		auto size() const -> size_type {
+			size_type total = 0;
+			for(auto const& s : shards) {
+				std::shared_lock lock(s->mutex);
+				total += s->positions.size();
+			}
+			return total;
+		}
+
+	private:
+		// The allocation a string keeps alive: its whole block, header included, even if the string only views a few of its characters
+		// Literals and static strings keep no block alive, and are only charged for their handle
+		static auto get_charge(string_type const& s) noexcept -> size_type {
+			size_type const bytes = s.block_bytes();
+			return bytes != 0 ? bytes : sizeof(string_type);
+		}
+
+		struct slot {
+			string_type key;
+			string_type value;
+			size_type charge = 0;
+			mutable std::atomic<bool> referenced{ false };
+			bool occupied = false;
+		};
+
+		struct shard {
+			explicit shard(size_type capacity_bytes) : capacity_bytes(capacity_bytes) {}
+
+			void evict(size_type index) {
+				slot& entry = slots[index];
+				positions.erase(entry.key);
+				used_bytes -= entry.charge;
+				entry.key.clear();
+				entry.value.clear();
+				entry.charge = 0;
+				entry.occupied = false;
+				free_slots.push_back(index);
+			}
+
+			// Sweeps the clock hand, giving referenced entries a second chance, until charge more bytes fit
+			// The entry at the kept index is never evicted
+			void evict_until_fits(size_type charge, size_type kept) {
+				while(used_bytes + charge > capacity_bytes) {
+					if(hand >= slots.size()) {
+						hand = 0;
+					}
+					slot& entry = slots[hand];
+					if(entry.occupied && hand != kept && !entry.referenced.exchange(false, std::memory_order_relaxed)) {
+						evict(hand);
+					}
+					++hand;
+				}
+			}
+
+			mutable std::shared_mutex mutex;
+			size_type const capacity_bytes;
+			size_type used_bytes = 0;
+			size_type hand = 0;
+			std::unordered_map<string_type, size_type, Hash> positions;
+			std::deque<slot> slots; // a deque never moves its elements, which have an atomic
+			std::vector<size_type> free_slots;
+		};
+
+		auto get_shard(string_type const& key) const -> shard& {
+			return *shards[Hash()(key) % shards.size()];
+		}
+
+		std::vector<std::unique_ptr<shard>> shards;
+	};
+}
@@ -0,0 +1,251 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "shared_string.hpp"
+#include "shared_string_simd.hpp"
+
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// ASCII case-insensitive operations, meant for protocol tokens like HTTP header names and host names
+// Only the letters A to Z are folded, other characters, including non-ASCII ones, must match exactly
+namespace kab
+{
+	namespace detail {
+		template<typename CharT>
+		constexpr auto ascii_to_lower(CharT c) noexcept -> CharT {
+			return c >= CharT('A') && c <= CharT('Z') ? CharT(c - CharT('A') + CharT('a')) : c;
+		}
+
+#ifdef SHARED_STRING_SSE2
+		// Bytes of 0x80 and above are negative for the signed comparisons, so they are never taken for letters
+		inline auto ascii_to_lower(__m128i chars) noexcept -> __m128i {
+			__m128i const upper = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1)));
+			return _mm_or_si128(chars, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+		}
+#endif
+
+		// Whether none of the characters is an ASCII upper case letter
+		template<typename CharT>
+		bool is_ascii_lower(CharT const* str, std::size_t size) noexcept {
+			std::size_t i = 0;
+#ifdef SHARED_STRING_SSE2
+			if constexpr(sizeof(CharT) == 1) {
+				for(; i + 16 <= size; i += 16) {
+					__m128i const chars = load_chars(str + i);
+					if(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, ascii_to_lower(chars))) != 0xFFFF) {
+						return false;
+					}
+				}
+			}
+#endif
+			for(; i < size; ++i) {
+				if(str[i] >= CharT('A') && str[i] <= CharT('Z')) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Position of the first character differing once folded, or size if there is none
+		template<typename CharT>
+		auto find_folded_mismatch(CharT const* lhs, CharT const* rhs, std::size_t size) noexcept -> std::size_t {
+			std::size_t i = 0;
+#ifdef SHARED_STRING_SSE2
+			if constexpr(sizeof(CharT) == 1) {
+				for(; i + 16 <= size; i += 16) {
+					__m128i const equal = _mm_cmpeq_epi8(ascii_to_lower(load_chars(lhs + i)), ascii_to_lower(load_chars(rhs + i)));
+					unsigned const mask = static_cast<unsigned>(_mm_movemask_epi8(equal));
+					if(mask != 0xFFFF) {
+						return i + count_trailing_zeros(~mask);
+					}
+				}
+			}
+#endif
+			for(; i < size; ++i) {
+				if(ascii_to_lower(lhs[i]) != ascii_to_lower(rhs[i])) {
+					return i;
+				}
+			}
+			return size;
+		}
+
+		// Same as hash_characters over the folded characters, so equal to std::hash of the lower case string
+		// Also tells whether the characters were already lower case, since it sees all of them anyway
+		template<typename CharT>
+		auto hash_folded(CharT const* str, std::size_t size, bool& was_lower) noexcept -> std::size_t {
+			using traits = std::char_traits<CharT>;
+			std::uint64_t hash = 14695981039346656037ull;
+			bool lower = true;
+			std::size_t i = 0;
+#ifdef SHARED_STRING_SSE2
+			if constexpr(sizeof(CharT) == 1) {
+				alignas(16) CharT folded[16];
+				for(; i + 16 <= size; i += 16) {
+					__m128i const chars = load_chars(str + i);
+					__m128i const lowered = ascii_to_lower(chars);
+					lower = lower && _mm_movemask_epi8(_mm_cmpeq_epi8(chars, lowered)) == 0xFFFF;
+					_mm_store_si128(reinterpret_cast<__m128i*>(folded), lowered);
+					for(CharT const c : folded) {
+						hash ^= static_cast<std::uint64_t>(traits::to_int_type(c));
+						hash *= 1099511628211ull;
+					}
+				}
+			}
+#endif
+			for(; i < size; ++i) {
+				CharT const c = ascii_to_lower(str[i]);
+				lower = lower && c == str[i];
+				hash ^= static_cast<std::uint64_t>(traits::to_int_type(c));
+				hash *= 1099511628211ull;
+			}
+			was_lower = lower;
+			return static_cast<std::size_t>(hash);
+		}
+
+		inline void cache_lower(std::atomic<unsigned>* flags, bool lower) noexcept {
+			if(flags) {
+				flags->fetch_or(block_lower_known | (lower ? block_is_lower : 0u), std::memory_order_relaxed);
+			}
+		}
+		// Whether the string is known to be lower case from the flags of its block, without looking at its characters
+		template<typename String>
+		bool is_known_lower(String const& s) noexcept {
+			auto const flags = flags_access::get(s);
+			unsigned const f = flags ? flags->load(std::memory_order_relaxed) : 0u;
+			return (f & block_lower_known) && (f & block_is_lower);
+		}
+	}
+
+	// Whether the string has no ASCII upper case letter
+	// For a string viewing a whole block, the answer is cached in the block, and shared with every string viewing it
+	template<typename CharT, typename Traits, typename Allocator>
+	bool is_ascii_lower(basic_shared_string<CharT, Traits, Allocator> const& s) noexcept {
+		auto const flags = detail::flags_access::get(s);
+		if(flags) {
+			unsigned const f = flags->load(std::memory_order_relaxed);
+			if(f & detail::block_lower_known) {
+				return (f & detail::block_is_lower) != 0;
+			}
+		}
+		bool const lower = detail::is_ascii_lower(s.data(), s.size());
+		detail::cache_lower(flags, lower);
+		return lower;
+	}
+
+	// Two strings known to be lower case, like keys already hashed with ihash, are compared byte for byte
+	template<typename CharT, typename Traits, typename Allocator>
+	bool iequals(basic_shared_string<CharT, Traits, Allocator> const& lhs, basic_shared_string<CharT, Traits, Allocator> const& rhs) noexcept {
+		if(lhs.size() != rhs.size()) {
+			return false;
+		}
+		if(lhs.data() == rhs.data()) {
+			return true;
+		}
+		if(detail::is_known_lower(lhs) && detail::is_known_lower(rhs)) {
+			return detail::equal_characters<std::char_traits<CharT>>(lhs.data(), rhs.data(), lhs.size());
+		}
+		return detail::find_folded_mismatch(lhs.data(), rhs.data(), lhs.size()) == lhs.size();
+	}
+
+	// Compares the strings as if both were folded to lower case
+	template<typename CharT, typename Traits, typename Allocator>
+	auto icompare(basic_shared_string<CharT, Traits, Allocator> const& lhs, basic_shared_string<CharT, Traits, Allocator> const& rhs) noexcept -> int {
+		std::size_t const common = (std::min)(lhs.size(), rhs.size());
+		std::size_t const mismatch = detail::find_folded_mismatch(lhs.data(), rhs.data(), common);
+		if(mismatch != common) {
+			auto const l = std::char_traits<CharT>::to_int_type(detail::ascii_to_lower(lhs[mismatch]));
+			auto const r = std::char_traits<CharT>::to_int_type(detail::ascii_to_lower(rhs[mismatch]));
+			return l < r ? -1 : 1;
+		}
+		return lhs.size() < rhs.size() ? -1 : lhs.size() > rhs.size() ? 1 : 0;
+	}
+
+	// Hash equal for strings equal with iequals, and to std::hash of the lower case string
+	// Also caches in the string's block whether it is lower case, which lets iequals skip folding it
+	template<typename CharT, typename Traits, typename Allocator>
+	auto ihash(basic_shared_string<CharT, Traits, Allocator> const& s) noexcept -> std::size_t {
+		bool lower = false;
+		std::size_t const hash = detail::hash_folded(s.data(), s.size(), lower);
+		if(auto const flags = detail::flags_access::get(s)) {
+			if((flags->load(std::memory_order_relaxed) & detail::block_lower_known) == 0) {
+				detail::cache_lower(flags, lower);
+			}
+		}
+		return hash;
+	}
+
+	// Position of the first occurrence of needle at or after pos ignoring case, or npos
+	template<typename CharT, typename Traits, typename Allocator>
+	auto ifind(basic_shared_string<CharT, Traits, Allocator> const& haystack, std::basic_string_view<CharT, Traits> needle, std::size_t pos = 0)
+		-> typename basic_shared_string<CharT, Traits, Allocator>::size_type {
+		using string_type = basic_shared_string<CharT, Traits, Allocator>;
+		if(needle.size() > haystack.size() || pos > haystack.size() - needle.size()) {
+			return string_type::npos;
+		}
+		if(needle.empty()) {
+			return pos;
+		}
+
+		std::basic_string<CharT> folded(needle.data(), needle.size());
+		for(CharT& c : folded) {
+			c = detail::ascii_to_lower(c);
+		}
+		CharT const* const str = haystack.data();
+		std::size_t const last = haystack.size() - needle.size();
+		auto const matches_at = [&](std::size_t i) {
+			return detail::find_folded_mismatch(str + i + 1, folded.data() + 1, folded.size() - 1) == folded.size() - 1;
+		};
+
+		std::size_t i = pos;
+#ifdef SHARED_STRING_SSE2
+		if constexpr(sizeof(CharT) == 1) {
+			// Candidates are the positions of the first character of the needle, 16 at a time
+			__m128i const first = _mm_set1_epi8(static_cast<char>(folded[0]));
+			for(; i + 16 <= last + 1; i += 16) {
+				unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(detail::ascii_to_lower(detail::load_chars(str + i)), first)));
+				while(mask != 0) {
+					std::size_t const candidate = i + detail::count_trailing_zeros(mask);
+					if(matches_at(candidate)) {
+						return candidate;
+					}
+					mask &= mask - 1;
+				}
+			}
+		}
+#endif
+		for(; i <= last; ++i) {
+			if(detail::ascii_to_lower(str[i]) == folded[0] && matches_at(i)) {
+				return i;
+			}
+		}
+		return string_type::npos;
+	}
+
+	// Function objects for containers keyed by strings ignoring case, like std::unordered_map<shared_string, T, case_insensitive_hash, case_insensitive_equal>
+	struct case_insensitive_hash {
+		template<typename String>
+		auto operator()(String const& s) const noexcept -> std::size_t {
+			return ihash(s);
+		}
+	};
+	struct case_insensitive_equal {
+		template<typename String>
+		bool operator()(String const& lhs, String const& rhs) const noexcept {
+			return iequals(lhs, rhs);
+		}
+	};
+	struct case_insensitive_less {
+		template<typename String>
+		bool operator()(String const& lhs, String const& rhs) const noexcept {
+			return icompare(lhs, rhs) < 0;
+		}
+	};
+}
@@ -0,0 +1,319 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "shared_string.hpp"
+
+#include <vector>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <optional>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+namespace kab
+{
+	// Append-only column of strings stored Arrow-style: the rows are split into chunks of a fixed number of rows,
+	// and each chunk keeps the characters of its rows back to back in a single shared block, delimited by an offsets array
+	// Any row can be extracted in constant time as a basic_shared_string sharing the chunk's block
+	template<
+		typename CharT,
+		typename Traits = std::char_traits<CharT>,
+		typename Allocator = std::allocator<CharT>
+	> class basic_shared_string_column {
+	public:
+		using string_type = basic_shared_string<CharT, Traits, Allocator>;
+		using string_view = std::basic_string_view<CharT, Traits>;
+		using size_type = std::size_t;
+		using offset_type = std::int64_t;
+		using allocator_type = Allocator;
+
+		// The rows of a chunk, as handed out by get_chunk
+		struct chunk {
+			string_type data; // the characters of the rows, back to back
+			// Row r of the chunk spans [offsets[r], offsets[r + 1]). The capacity is reserved up front, so appending a row
+			// never moves the offsets of the previous rows, which can be shared with readers like an exported Arrow array
+			// The column keeps appending to the same vector, so only its first rows + 1 offsets belong to the chunk,
+			// and its size must not be read while the column may push rows
+			std::shared_ptr<std::vector<offset_type>> offsets;
+			size_type rows; // the rows pushed when the chunk was handed out
+		};
+
+		// Throws: std::invalid_argument if rows_per_chunk is 0
+		explicit basic_shared_string_column(size_type rows_per_chunk = 4096, size_type initial_chunk_capacity = 1 << 14, Allocator const& alloc = Allocator())
+			: rows_per_chunk(rows_per_chunk)
+			, initial_chunk_capacity(initial_chunk_capacity)
+			, alloc(alloc) {
+			if(rows_per_chunk == 0) {
+				throw std::invalid_argument("basic_shared_string_column needs at least one row per chunk");
+			}
+		}
+		// The free capacity of the blocks belongs to a single column, which may write to it at any time
+		basic_shared_string_column(basic_shared_string_column const&) = delete;
+		// The moved-from column is left empty
+		basic_shared_string_column(basic_shared_string_column && other) noexcept
+			: rows_per_chunk(other.rows_per_chunk)
+			, initial_chunk_capacity(other.initial_chunk_capacity)
+			, alloc(std::move(other.alloc))
+			, chunks(std::move(other.chunks))
+			, row_count(std::exchange(other.row_count, 0)) {
+			other.chunks.clear();
+		}
+		auto operator=(basic_shared_string_column const&) -> basic_shared_string_column & = delete;
+		auto operator=(basic_shared_string_column && other) noexcept -> basic_shared_string_column & {
+			if(this != &other) {
+				seal_last_chunk();
+				rows_per_chunk = other.rows_per_chunk;
+				initial_chunk_capacity = other.initial_chunk_capacity;
+				alloc = std::move(other.alloc);
+				chunks = std::move(other.chunks);
+				other.chunks.clear();
+				row_count = std::exchange(other.row_count, 0);
+			}
+			return *this;
+		}
+		~basic_shared_string_column() {
+			seal_last_chunk();
+		}
+
+		void push_back(string_view value) {
+			if(chunks.empty() || chunks.back().offsets->size() == rows_per_chunk + 1) {
+				auto offsets = std::make_shared<std::vector<offset_type>>();
+				offsets->reserve(rows_per_chunk + 1);
+				offsets->push_back(0);
+				auto [block, characters] = detail::bulk_access::make_writable<string_type>((std::max)(value.size(), initial_chunk_capacity), alloc);
+				chunks.push_back(storage{ std::move(block), characters, std::move(offsets) });
+			}
+
+			storage& c = chunks.back();
+			auto const used = c.get_used();
+			if(used + value.size() > c.block.size()) {
+				// Rows already extracted keep the previous block alive, so it can be replaced like a vector's buffer
+				auto [grown, characters] = detail::bulk_access::make_writable<string_type>((std::max)(2 * c.block.size(), used + value.size()), alloc);
+				Traits::copy(characters, c.characters, used);
+				detail::bulk_access::seal(c.block, used);
+				c.block = std::move(grown);
+				c.characters = characters;
+			}
+			Traits::copy(c.characters + used, value.data(), value.size());
+			c.offsets->push_back(static_cast<offset_type>(used + value.size()));
+			++row_count;
+			if(c.offsets->size() == rows_per_chunk + 1) {
+				detail::bulk_access::seal(c.block, c.get_used());
+			}
+		}
+
+		auto operator[](size_type row) const -> string_type {
+			storage const& c = chunks[row / rows_per_chunk];
+			auto const& offsets = *c.offsets;
+			size_type const r = row % rows_per_chunk;
+			return c.block.substr(static_cast<size_type>(offsets[r]), static_cast<size_type>(offsets[r + 1] - offsets[r]));
+		}
+		// Same as operator[], without touching the reference count
+		auto view(size_type row) const -> string_view {
+			storage const& c = chunks[row / rows_per_chunk];
+			auto const& offsets = *c.offsets;
+			size_type const r = row % rows_per_chunk;
+			return string_view(c.block.data() + offsets[r], static_cast<size_type>(offsets[r + 1] - offsets[r]));
+		}
+
+		// Calls f(row, view) for every row in order, walking each chunk's offsets and characters sequentially
+		template<typename F>
+		void for_each(F&& f) const {
+			size_type row = 0;
+			for(storage const& c : chunks) {
+				CharT const* const data = c.block.data();
+				auto const& offsets = *c.offsets;
+				for(size_type r = 0; r + 1 < offsets.size(); ++r, ++row) {
+					f(row, string_view(data + offsets[r], static_cast<size_type>(offsets[r + 1] - offsets[r])));
+				}
+			}
+		}
+		auto count(string_view value) const -> size_type {
+			size_type result = 0;
+			for(storage const& c : chunks) {
+				CharT const* const data = c.block.data();
+				auto const& offsets = *c.offsets;
+				for(size_type r = 0; r + 1 < offsets.size(); ++r) {
+					auto const length = static_cast<size_type>(offsets[r + 1] - offsets[r]);
+					result += length == value.size() && detail::equal_characters<Traits>(data + offsets[r], value.data(), length);
+				}
+			}
+			return result;
+		}
+
+		// The rows pushed so far to a chunk. Later rows are not part of the returned chunk, even if they extend its offsets
+		auto get_chunk(size_type index) const -> chunk {
+			storage const& c = chunks[index];
+			return chunk{ c.block.substr(0, c.get_used()), c.offsets, c.offsets->size() - 1 };
+		}
+		auto get_chunk_count() const noexcept -> size_type { return chunks.size(); }
+		auto get_rows_per_chunk() const noexcept -> size_type { return rows_per_chunk; }
+		auto get_allocator() const noexcept -> allocator_type { return alloc; }
+		auto size() const noexcept -> size_type { return row_count; }
+		[[nodiscard]] bool empty() const noexcept { return row_count == 0; }
+
+	private:
+		// The column writes the characters of new rows past the used part of a block it allocated, which no string handed out views
+		struct storage {
+			string_type block;
+			CharT* characters;
+			std::shared_ptr<std::vector<offset_type>> offsets;
+
+			auto get_used() const noexcept -> size_type { return static_cast<size_type>(offsets->back()); }
+		};
+
+		// Rows extracted from the last chunk outlive the column's hold on it, and can cache the properties of its block from now on
+		void seal_last_chunk() noexcept {
+			if(!chunks.empty() && chunks.back().offsets->size() != rows_per_chunk + 1) {
+				detail::bulk_access::seal(chunks.back().block, chunks.back().get_used());
+			}
+		}
+
+		size_type rows_per_chunk;
+		size_type initial_chunk_capacity;
+		Allocator alloc;
+		std::vector<storage> chunks;
+		size_type row_count = 0;
+	};
+
+	using shared_string_column = basic_shared_string_column<char>;
+
+	// Column of strings stored as one small integer code per row, indexing a dictionary holding each distinct value once
+	// Equality and membership filters are evaluated on the codes, without looking at the characters of the rows
+	template<
+		typename CharT,
+		typename Code = std::uint32_t,
+		typename Traits = std::char_traits<CharT>,
+		typename Allocator = std::allocator<CharT>
+	> class basic_dictionary_column {
+	public:
+		using string_type = basic_shared_string<CharT, Traits, Allocator>;
+		using string_view = std::basic_string_view<CharT, Traits>;
+		using code_type = Code;
+		using size_type = std::size_t;
+		using allocator_type = Allocator;
+
+		explicit basic_dictionary_column(Allocator const& alloc = Allocator())
+			: alloc(alloc) {
+
+		}
+		// The index views the characters of the dictionary's strings. Copies of those strings share the same characters,
+		// except when the allocator gives the copy a new one, so the copy's index is rebuilt over its own strings
+		basic_dictionary_column(basic_dictionary_column const& other)
+			: alloc(other.alloc)
+			, dictionary(other.dictionary)
+			, codes(other.codes) {
+			index.reserve(dictionary.size());
+			for(size_type code = 0; code < dictionary.size(); ++code) {
+				index.emplace(string_view(dictionary[code].data(), dictionary[code].size()), static_cast<code_type>(code));
+			}
+		}
+		basic_dictionary_column(basic_dictionary_column &&) = default;
+		auto operator=(basic_dictionary_column const& other) -> basic_dictionary_column & {
+			if(this != &other) {
+				*this = basic_dictionary_column(other);
+			}
+			return *this;
+		}
+		auto operator=(basic_dictionary_column &&) -> basic_dictionary_column & = default;
+
+		// A value already in the dictionary is stored as its code, without allocating
+		void push_back(string_view value) {
+			codes.push_back(get_or_add_code(value, [&] { return string_type(value, alloc); }));
+		}
+		// A new value shares the storage of the given string
+		void push_back(string_type const& value) {
+			codes.push_back(get_or_add_code(string_view(value.data(), value.size()), [&] { return value; }));
+		}
+		template<typename InputIt>
+		void encode(InputIt first, InputIt last) {
+			for(; first != last; ++first) {
+				push_back(*first);
+			}
+		}
+
+		auto operator[](size_type row) const -> string_type {
+			return dictionary[codes[row]];
+		}
+		template<typename OutputIt>
+		auto decode(size_type first_row, size_type last_row, OutputIt out) const -> OutputIt {
+			for(size_type row = first_row; row < last_row; ++row) {
+				*out++ = dictionary[codes[row]];
+			}
+			return out;
+		}
+
+		auto find_code(string_view value) const -> std::optional<code_type> {
+			auto const it = index.find(value);
+			return it != index.end() ? std::optional<code_type>(it->second) : std::nullopt;
+		}
+		// The rows equal to value, in increasing order
+		auto filter_equal(string_view value) const -> std::vector<size_type> {
+			std::vector<size_type> rows;
+			if(auto const code = find_code(value)) {
+				for(size_type row = 0; row < codes.size(); ++row) {
+					if(codes[row] == *code) {
+						rows.push_back(row);
+					}
+				}
+			}
+			return rows;
+		}
+		// The rows equal to any of the values, in increasing order
+		template<typename InputIt>
+		auto filter_in(InputIt first, InputIt last) const -> std::vector<size_type> {
+			std::vector<unsigned char> selected(dictionary.size());
+			for(; first != last; ++first) {
+				if(auto const code = find_code(string_view(*first))) {
+					selected[*code] = 1;
+				}
+			}
+			std::vector<size_type> rows;
+			for(size_type row = 0; row < codes.size(); ++row) {
+				if(selected[codes[row]]) {
+					rows.push_back(row);
+				}
+			}
+			return rows;
+		}
+
+		auto get_codes() const noexcept -> std::vector<code_type> const& { return codes; }
+		auto get_dictionary() const noexcept -> std::vector<string_type> const& { return dictionary; }
+		auto get_allocator() const noexcept -> allocator_type { return alloc; }
+		auto size() const noexcept -> size_type { return codes.size(); }
+		[[nodiscard]] bool empty() const noexcept { return codes.empty(); }
+
+	private:
+		template<typename MakeString>
+		auto get_or_add_code(string_view value, MakeString const& make_string) -> code_type {
+			auto const it = index.find(value);
+			if(it != index.end()) {
+				return it->second;
+			}
+			if(dictionary.size() > (std::numeric_limits<code_type>::max)()) {
+				throw std::length_error("Too many distinct values for the code type of basic_dictionary_column");
+			}
+			auto const code = static_cast<code_type>(dictionary.size());
+			dictionary.push_back(make_string());
+			// Moving the dictionary's handles never moves their characters, so the index can view them
+			string_type const& stored = dictionary.back();
+			index.emplace(string_view(stored.data(), stored.size()), code);
+			return code;
+		}
+
+		Allocator alloc;
+		std::vector<string_type> dictionary;
+		std::unordered_map<string_view, code_type> index;
+		std::vector<code_type> codes;
+	};
+
+	using dictionary_column = basic_dictionary_column<char>;
+}
@@ -0,0 +1,234 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "shared_string.hpp"
+
+#include <vector>
+#include <variant>
+#include <memory>
+#include <bitset>
+#include <functional>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+namespace kab
+{
+	// Immutable hash array mapped trie from strings to values
+	// Every modification returns a new map sharing all the unmodified nodes with the original, so copying a map is constant,
+	// and a modification only copies the nodes on the path to the key, which is logarithmic in base 32
+	template<typename String, typename T, typename Hash = std::hash<String>>
+	class basic_persistent_map {
+		static constexpr unsigned bits_per_level = 5;
+		static constexpr unsigned hash_bits = sizeof(std::size_t) * CHAR_BIT;
+
+		struct node;
+		using node_ptr = std::shared_ptr<node const>;
+
+		struct leaf {
+			std::size_t hash;
+			String key;
+			T value;
+		};
+		using entry = std::variant<leaf, node_ptr>;
+
+		// Below the last level of hash bits, a node is a plain list of leaves whose hashes collide
+		struct node {
+			std::uint32_t bitmap = 0;
+			std::vector<entry> entries;
+		};
+
+	public:
+		using key_type = String;
+		using mapped_type = T;
+		using size_type = std::size_t;
+
+		basic_persistent_map() = default;
+
+		auto find(key_type const& key) const -> mapped_type const* {
+			std::size_t const hash = Hash()(key);
+			node const* current = root.get();
+			for(unsigned shift = 0; current != nullptr; shift += bits_per_level) {
+				if(shift >= hash_bits) {
+					for(entry const& e : current->entries) {
+						leaf const& l = std::get<leaf>(e);
+						if(l.key == key) {
+							return &l.value;
+						}
+					}
+					return nullptr;
+				}
+
+				std::uint32_t const bit = get_bit(hash, shift);
+				if((current->bitmap & bit) == 0) {
+					return nullptr;
+				}
+				entry const& e = current->entries[get_position(current->bitmap, bit)];
+				if(auto const l = std::get_if<leaf>(&e)) {
+					return l->hash == hash && l->key == key ? &l->value : nullptr;
+				}
+				current = std::get<node_ptr>(e).get();
+			}
+			return nullptr;
+		}
+		bool contains(key_type const& key) const {
+			return find(key) != nullptr;
+		}
+
+		// Returns a map where key is mapped to value
+		[[nodiscard]] auto set(key_type const& key, mapped_type const& value) const -> basic_persistent_map {
+			bool added = false;
+			node_ptr new_root = set(root.get(), 0, leaf{ Hash()(key), key, value }, added);
+			return basic_persistent_map(std::move(new_root), count + (added ? 1 : 0));
+		}
+		// Returns a map without key
+		[[nodiscard]] auto erase(key_type const& key) const -> basic_persistent_map {
+			bool removed = false;
+			node_ptr new_root = erase(root, 0, Hash()(key), key, removed);
+			return removed ? basic_persistent_map(std::move(new_root), count - 1) : *this;
+		}
+
+		// Calls f(key, value) for every element, in an unspecified order
+		template<typename F>
+		void for_each(F&& f) const {
+			if(root) {
+				for_each(*root, f);
+			}
+		}
+
+		auto size() const noexcept -> size_type { return count; }
+		[[nodiscard]] bool empty() const noexcept { return count == 0; }
+
+	private:
+		basic_persistent_map(node_ptr root, size_type count)
+			: root(std::move(root))
+			, count(count) {
+
+		}
+
+		static auto get_bit(std::size_t hash, unsigned shift) noexcept -> std::uint32_t {
+			return std::uint32_t(1) << ((hash >> shift) & ((1u << bits_per_level) - 1));
+		}
+		static auto get_position(std::uint32_t bitmap, std::uint32_t bit) noexcept -> std::size_t {
+			return std::bitset<32>(bitmap & (bit - 1)).count();
+		}
+
+		static auto set(node const* current, unsigned shift, leaf&& new_leaf, bool& added) -> node_ptr {
+			auto result = current != nullptr ? std::make_shared<node>(*current) : std::make_shared<node>();
+
+			if(shift >= hash_bits) {
+				for(entry& e : result->entries) {
+					leaf& l = std::get<leaf>(e);
+					if(l.key == new_leaf.key) {
+						l.value = std::move(new_leaf.value);
+						return result;
+					}
+				}
+				result->entries.emplace_back(std::move(new_leaf));
+				added = true;
+				return result;
+			}
+
+			std::uint32_t const bit = get_bit(new_leaf.hash, shift);
+			auto const position = result->entries.begin() + get_position(result->bitmap, bit);
+			if((result->bitmap & bit) == 0) {
+				result->bitmap |= bit;
+				result->entries.emplace(position, std::move(new_leaf));
+				added = true;
+			} else if(auto const l = std::get_if<leaf>(&*position)) {
+				if(l->hash == new_leaf.hash && l->key == new_leaf.key) {
+					l->value = std::move(new_leaf.value);
+				} else {
+					// Push both leaves one level down, where their hashes may differ
+					leaf existing = std::move(*l);
+					bool ignored = false;
+					node_ptr child = set(nullptr, shift + bits_per_level, std::move(existing), ignored);
+					*position = set(child.get(), shift + bits_per_level, std::move(new_leaf), added);
+				}
+			} else {
+				node_ptr const& child = std::get<node_ptr>(*position);
+				*position = set(child.get(), shift + bits_per_level, std::move(new_leaf), added);
+			}
+			return result;
+		}
+
+		static auto erase(node_ptr const& current, unsigned shift, std::size_t hash, key_type const& key, bool& removed) -> node_ptr {
+			if(current == nullptr) {
+				return current;
+			}
+
+			if(shift >= hash_bits) {
+				for(std::size_t i = 0; i < current->entries.size(); ++i) {
+					if(std::get<leaf>(current->entries[i]).key == key) {
+						removed = true;
+						if(current->entries.size() == 1) {
+							return nullptr;
+						}
+						auto result = std::make_shared<node>(*current);
+						result->entries.erase(result->entries.begin() + i);
+						return result;
+					}
+				}
+				return current;
+			}
+
+			std::uint32_t const bit = get_bit(hash, shift);
+			if((current->bitmap & bit) == 0) {
+				return current;
+			}
+			std::size_t const position = get_position(current->bitmap, bit);
+			entry const& e = current->entries[position];
+
+			std::variant<std::monostate, node_ptr, leaf> replacement;
+			if(auto const l = std::get_if<leaf>(&e)) {
+				if(l->hash != hash || !(l->key == key)) {
+					return current;
+				}
+				removed = true;
+			} else {
+				node_ptr const& child = std::get<node_ptr>(e);
+				node_ptr new_child = erase(child, shift + bits_per_level, hash, key, removed);
+				if(!removed) {
+					return current;
+				}
+				// A child left with a single leaf is folded back into this node
+				if(new_child != nullptr && new_child->entries.size() == 1 && std::holds_alternative<leaf>(new_child->entries.front())) {
+					replacement = std::get<leaf>(new_child->entries.front());
+				} else if(new_child != nullptr) {
+					replacement = std::move(new_child);
+				}
+			}
+
+			if(std::holds_alternative<std::monostate>(replacement) && current->entries.size() == 1) {
+				return nullptr;
+			}
+			auto result = std::make_shared<node>(*current);
+			if(auto const l = std::get_if<leaf>(&replacement)) {
+				result->entries[position] = std::move(*l);
+			} else if(auto const child = std::get_if<node_ptr>(&replacement)) {
+				result->entries[position] = std::move(*child);
+			} else {
+				result->bitmap &= ~bit;
+				result->entries.erase(result->entries.begin() + position);
+			}
+			return result;
+		}
+
+		template<typename F>
+		static void for_each(node const& current, F& f) {
+			for(entry const& e : current.entries) {
+				if(auto const l = std::get_if<leaf>(&e)) {
+					f(l->key, l->value);
+				} else {
+					for_each(*std::get<node_ptr>(e), f);
+				}
+			}
+		}
+
+		node_ptr root;
+		size_type count = 0;
+	};
+}
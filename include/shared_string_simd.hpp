@@ -0,0 +1,34 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+// Helpers shared by the vectorized kernels, which use SSE2 when the target has it and scalar loops otherwise
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SHARED_STRING_SSE2
+#endif
+
+namespace kab
+{
+	namespace detail {
+#ifdef SHARED_STRING_SSE2
+		inline auto load_chars(void const* p) noexcept -> __m128i {
+			return _mm_loadu_si128(static_cast<__m128i const*>(p));
+		}
+#endif
+		inline auto count_trailing_zeros(unsigned mask) noexcept -> unsigned {
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+			unsigned count = 0;
+			for(; (mask & 1) == 0; mask >>= 1) {
+				++count;
+			}
+			return count;
+#endif
+		}
+	}
+}
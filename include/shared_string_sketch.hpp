@@ -0,0 +1,221 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "shared_string.hpp"
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+namespace kab
+{
+	namespace detail {
+		// Hashes like FNV-1a have weak high bits, which the sketches depend on
+		inline auto mix_hash(std::uint64_t h) noexcept -> std::uint64_t {
+			h ^= h >> 30;
+			h *= 0xbf58476d1ce4e5b9ull;
+			h ^= h >> 27;
+			h *= 0x94d049bb133111ebull;
+			h ^= h >> 31;
+			return h;
+		}
+	}
+
+	// Space-Saving summary of the top capacity() most frequent strings of a stream
+	// The tracked strings are held as shared handles, so tracking a string never copies its characters
+	// Summaries built on separate threads can be combined with merge
+	template<typename String, typename Hash = std::hash<String>>
+	class basic_space_saving {
+	public:
+		using string_type = String;
+		using size_type = std::size_t;
+
+		struct counter {
+			string_type value;
+			std::uint64_t count; // upper bound of the occurrences of value
+			std::uint64_t error; // count minus error is a lower bound of the occurrences of value
+		};
+
+		explicit basic_space_saving(size_type capacity)
+			: capacity_(capacity) {
+			assert(capacity > 0 && "Space-Saving needs at least one counter");
+			heap.reserve(capacity);
+			positions.reserve(capacity);
+		}
+
+		void add(string_type const& value, std::uint64_t occurrences = 1) {
+			auto const it = positions.find(value);
+			if(it != positions.end()) {
+				heap[it->second].count += occurrences;
+				sift_down(it->second);
+			} else if(heap.size() < capacity_) {
+				positions.emplace(value, heap.size());
+				heap.push_back(counter{ value, occurrences, 0 });
+				sift_up(heap.size() - 1);
+			} else {
+				// The least frequent value is evicted, and the new one inherits its count as error
+				counter& minimum = heap.front();
+				positions.erase(minimum.value);
+				minimum.value = value;
+				minimum.error = minimum.count;
+				minimum.count += occurrences;
+				positions.emplace(value, 0);
+				sift_down(0);
+			}
+		}
+
+		// Combines the summary of another part of the stream into this one
+		void merge(basic_space_saving const& other) {
+			std::uint64_t const this_minimum = heap.size() == capacity_ ? heap.front().count : 0;
+			std::uint64_t const other_minimum = other.heap.size() == other.capacity_ ? other.heap.front().count : 0;
+
+			std::vector<counter> merged;
+			merged.reserve(heap.size() + other.heap.size());
+			for(counter const& c : heap) {
+				auto const it = other.positions.find(c.value);
+				if(it != other.positions.end()) {
+					counter const& o = other.heap[it->second];
+					merged.push_back(counter{ c.value, c.count + o.count, c.error + o.error });
+				} else {
+					merged.push_back(counter{ c.value, c.count + other_minimum, c.error + other_minimum });
+				}
+			}
+			for(counter const& o : other.heap) {
+				if(positions.find(o.value) == positions.end()) {
+					merged.push_back(counter{ o.value, o.count + this_minimum, o.error + this_minimum });
+				}
+			}
+
+			auto const kept = std::min(merged.size(), capacity_);
+			std::partial_sort(merged.begin(), merged.begin() + kept, merged.end(), [](counter const& lhs, counter const& rhs) {
+				return lhs.count > rhs.count;
+			});
+			merged.erase(merged.begin() + kept, merged.end());
+
+			heap = std::move(merged);
+			std::reverse(heap.begin(), heap.end()); // ascending counts already form a min-heap
+			positions.clear();
+			for(size_type i = 0; i < heap.size(); ++i) {
+				positions.emplace(heap[i].value, i);
+			}
+		}
+
+		// The tracked counters, most frequent first
+		auto top() const -> std::vector<counter> {
+			std::vector<counter> result(heap.begin(), heap.end());
+			std::sort(result.begin(), result.end(), [](counter const& lhs, counter const& rhs) {
+				return lhs.count > rhs.count;
+			});
+			return result;
+		}
+
+		auto size() const noexcept -> size_type { return heap.size(); }
+		auto capacity() const noexcept -> size_type { return capacity_; }
+
+	private:
+		void swap_counters(size_type lhs, size_type rhs) {
+			using std::swap;
+			swap(heap[lhs], heap[rhs]);
+			positions.find(heap[lhs].value)->second = lhs;
+			positions.find(heap[rhs].value)->second = rhs;
+		}
+		void sift_up(size_type index) {
+			while(index > 0) {
+				size_type const parent = (index - 1) / 2;
+				if(heap[parent].count <= heap[index].count) {
+					break;
+				}
+				swap_counters(parent, index);
+				index = parent;
+			}
+		}
+		void sift_down(size_type index) {
+			for(;;) {
+				size_type smallest = index;
+				size_type const left = 2 * index + 1;
+				size_type const right = left + 1;
+				if(left < heap.size() && heap[left].count < heap[smallest].count) {
+					smallest = left;
+				}
+				if(right < heap.size() && heap[right].count < heap[smallest].count) {
+					smallest = right;
+				}
+				if(smallest == index) {
+					break;
+				}
+				swap_counters(index, smallest);
+				index = smallest;
+			}
+		}
+
+		size_type capacity_;
+		std::vector<counter> heap; // min-heap on count
+		std::unordered_map<string_type, size_type, Hash> positions;
+	};
+
+	// HyperLogLog estimate of the number of distinct strings of a stream, in 2^precision bytes
+	// Sketches built on separate threads can be combined with merge, provided they have the same precision
+	template<typename String, typename Hash = std::hash<String>>
+	class basic_hyperloglog {
+	public:
+		using string_type = String;
+
+		explicit basic_hyperloglog(unsigned precision = 12)
+			: precision(precision)
+			, registers(std::size_t(1) << precision) {
+			assert(precision >= 4 && precision <= 18 && "HyperLogLog precision must be between 4 and 18");
+		}
+
+		void add(string_type const& value) noexcept {
+			std::uint64_t const hash = detail::mix_hash(Hash()(value));
+			std::size_t const index = static_cast<std::size_t>(hash >> (64 - precision));
+			std::uint64_t const remaining = hash << precision;
+
+			// Position of the first set bit of the remaining bits, counting from 1
+			std::uint8_t rank = 1;
+			for(std::uint64_t bit = std::uint64_t(1) << 63; rank <= 64 - precision && (remaining & bit) == 0; bit >>= 1) {
+				++rank;
+			}
+			registers[index] = std::max(registers[index], rank);
+		}
+
+		void merge(basic_hyperloglog const& other) noexcept {
+			assert(precision == other.precision && "Only HyperLogLog sketches of the same precision can be merged");
+			for(std::size_t i = 0; i < registers.size(); ++i) {
+				registers[i] = std::max(registers[i], other.registers[i]);
+			}
+		}
+
+		auto estimate() const noexcept -> double {
+			double const m = static_cast<double>(registers.size());
+			double sum = 0;
+			std::size_t zeros = 0;
+			for(std::uint8_t const r : registers) {
+				sum += std::ldexp(1.0, -r);
+				zeros += r == 0;
+			}
+			double const alpha = registers.size() == 16 ? 0.673
+				: registers.size() == 32 ? 0.697
+				: registers.size() == 64 ? 0.709
+				: 0.7213 / (1 + 1.079 / m);
+			double const raw = alpha * m * m / sum;
+			// Linear counting is more precise while many registers are still empty
+			if(raw <= 2.5 * m && zeros != 0) {
+				return m * std::log(m / static_cast<double>(zeros));
+			}
+			return raw;
+		}
+
+	private:
+		unsigned precision;
+		std::vector<std::uint8_t> registers;
+	};
+}
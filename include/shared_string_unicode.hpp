@@ -0,0 +1,449 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "shared_string.hpp"
+#include "shared_string_simd.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <atomic>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+// Unicode operations on strings of UTF-8 code units, and transcoding between UTF-8, UTF-16 and UTF-32 strings
+// The properties of the characters of a block, like being valid UTF-8, are cached in the block's header once computed
+namespace kab
+{
+	namespace detail {
+		inline bool is_utf8_continuation(unsigned char byte) noexcept {
+			return (byte & 0xC0) == 0x80;
+		}
+
+		// Length of the valid sequence starting with a non-ASCII byte, or 0 if the sequence is invalid or truncated
+		// Rejects overlong forms, surrogates, and code points above U+10FFFF, as required by RFC 3629
+		inline auto get_utf8_sequence_length(unsigned char const* bytes, std::size_t available) noexcept -> std::size_t {
+			unsigned char const lead = bytes[0];
+			auto const in_range = [&](std::size_t i, unsigned char low, unsigned char high) {
+				return i < available && bytes[i] >= low && bytes[i] <= high;
+			};
+			if(lead >= 0xC2 && lead <= 0xDF) {
+				return in_range(1, 0x80, 0xBF) ? 2 : 0;
+			}
+			if(lead >= 0xE0 && lead <= 0xEF) {
+				unsigned char const low = lead == 0xE0 ? 0xA0 : 0x80;
+				unsigned char const high = lead == 0xED ? 0x9F : 0xBF;
+				return in_range(1, low, high) && in_range(2, 0x80, 0xBF) ? 3 : 0;
+			}
+			if(lead >= 0xF0 && lead <= 0xF4) {
+				unsigned char const low = lead == 0xF0 ? 0x90 : 0x80;
+				unsigned char const high = lead == 0xF4 ? 0x8F : 0xBF;
+				return in_range(1, low, high) && in_range(2, 0x80, 0xBF) && in_range(3, 0x80, 0xBF) ? 4 : 0;
+			}
+			return 0;
+		}
+
+		// Position of the first byte at or after pos which is not ASCII, or size
+		inline auto find_non_ascii(unsigned char const* bytes, std::size_t size, std::size_t pos = 0) noexcept -> std::size_t {
+			std::size_t i = pos;
+#ifdef SHARED_STRING_SSE2
+			for(; i + 16 <= size; i += 16) {
+				unsigned const mask = static_cast<unsigned>(_mm_movemask_epi8(load_chars(bytes + i)));
+				if(mask != 0) {
+					return i + count_trailing_zeros(mask);
+				}
+			}
+#endif
+			for(; i < size; ++i) {
+				if(bytes[i] >= 0x80) {
+					return i;
+				}
+			}
+			return size;
+		}
+
+		// Position of the first byte of the first invalid or truncated sequence, or size if the bytes are valid UTF-8
+		// Runs of ASCII are skipped a vector at a time, so only the multibyte sequences are decoded one by one
+		inline auto find_invalid_utf8(unsigned char const* bytes, std::size_t size) noexcept -> std::size_t {
+			std::size_t i = find_non_ascii(bytes, size);
+			while(i < size) {
+				std::size_t const length = get_utf8_sequence_length(bytes + i, size - i);
+				if(length == 0) {
+					return i;
+				}
+				i += length;
+				if(i < size && bytes[i] < 0x80) {
+					i = find_non_ascii(bytes, size, i);
+				}
+			}
+			return size;
+		}
+
+		template<typename String>
+		auto get_bytes(String const& s) noexcept -> unsigned char const* {
+			static_assert(sizeof(typename String::value_type) == 1, "UTF-8 strings are made of single byte code units");
+			return reinterpret_cast<unsigned char const*>(s.data());
+		}
+
+		// Computes a property of the characters the string views, with the cached flags of its block if they are known,
+		// and caches it in the block if the string views the whole block
+		template<typename String, typename FromBlock, typename Compute>
+		bool get_property(String const& s, unsigned known, unsigned value, FromBlock&& from_block, Compute&& compute) noexcept {
+			if(auto const block = flags_access::get_block(s)) {
+				unsigned const f = block->load(std::memory_order_relaxed);
+				if(f & known) {
+					int const result = from_block((f & value) != 0);
+					if(result >= 0) {
+						return result != 0;
+					}
+				}
+			}
+			unsigned flags = 0;
+			bool const result = compute(flags);
+			if(auto const whole = flags_access::get(s)) {
+				whole->fetch_or(flags, std::memory_order_relaxed);
+			}
+			return result;
+		}
+	}
+
+	// Whether every character is ASCII
+	// A substring of a block known to be ASCII is ASCII without looking at its characters
+	template<typename CharT, typename Traits, typename Allocator>
+	bool is_ascii(basic_shared_string<CharT, Traits, Allocator> const& s) noexcept {
+		auto const bytes = detail::get_bytes(s);
+		bool const whole = detail::flags_access::get(s) != nullptr;
+		return detail::get_property(s, detail::block_ascii_known, detail::block_is_ascii,
+			[&](bool block_is_ascii) { return block_is_ascii || whole ? int(block_is_ascii) : -1; },
+			[&](unsigned& flags) {
+				bool const ascii = detail::find_non_ascii(bytes, s.size()) == s.size();
+				flags = detail::block_ascii_known | (ascii ? detail::block_is_ascii | detail::block_utf8_known | detail::block_is_utf8 : 0u);
+				return ascii;
+			});
+	}
+
+	// Whether the characters are valid UTF-8
+	// A substring of a block known to be valid is valid without decoding it, if it does not start or end inside a sequence
+	template<typename CharT, typename Traits, typename Allocator>
+	bool is_valid_utf8(basic_shared_string<CharT, Traits, Allocator> const& s) noexcept {
+		auto const bytes = detail::get_bytes(s);
+		bool const whole = detail::flags_access::get(s) != nullptr;
+		return detail::get_property(s, detail::block_utf8_known, detail::block_is_utf8,
+			[&](bool block_is_utf8) {
+				if(whole) {
+					return int(block_is_utf8);
+				}
+				if(!block_is_utf8) {
+					return -1;
+				}
+				bool const ends_in_block = s.offset_in_block() + s.size() < s.block_size();
+				return int((s.empty() || !detail::is_utf8_continuation(bytes[0])) && !(ends_in_block && detail::is_utf8_continuation(bytes[s.size()])));
+			},
+			[&](unsigned& flags) {
+				bool const valid = detail::find_invalid_utf8(bytes, s.size()) == s.size();
+				flags = detail::block_utf8_known | (valid ? detail::block_is_utf8 : 0u);
+				return valid;
+			});
+	}
+
+	// Number of code points of valid UTF-8, which is the size of an ASCII string
+	// Requires: the string is valid UTF-8
+	template<typename CharT, typename Traits, typename Allocator>
+	auto count_code_points(basic_shared_string<CharT, Traits, Allocator> const& s) noexcept -> std::size_t {
+		if(is_ascii(s)) {
+			return s.size();
+		}
+		auto const bytes = detail::get_bytes(s);
+		std::size_t count = 0;
+		std::size_t i = 0;
+#ifdef SHARED_STRING_SSE2
+		// Every byte but the continuation bytes, 0x80 to 0xBF, starts a code point. Those are below -64 as signed bytes
+		for(; i + 16 <= s.size(); i += 16) {
+			__m128i const starts = _mm_cmpgt_epi8(detail::load_chars(bytes + i), _mm_set1_epi8(-65));
+			for(unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(starts)); mask != 0; mask &= mask - 1) {
+				++count;
+			}
+		}
+#endif
+		for(; i < s.size(); ++i) {
+			count += !detail::is_utf8_continuation(bytes[i]);
+		}
+		return count;
+	}
+
+	// Offset of the code unit starting the code point of the given index, or the size if the index is the number of code points
+	// Constant for ASCII strings, which have one code unit per code point
+	// Requires: the string is valid UTF-8, and index is at most the number of its code points
+	template<typename CharT, typename Traits, typename Allocator>
+	auto get_code_point_offset(basic_shared_string<CharT, Traits, Allocator> const& s, std::size_t index) noexcept -> std::size_t {
+		if(is_ascii(s)) {
+			return index;
+		}
+		auto const bytes = detail::get_bytes(s);
+		std::size_t i = 0;
+		for(std::size_t count = 0; i < s.size(); ++i) {
+			if(!detail::is_utf8_continuation(bytes[i]) && count++ == index) {
+				return i;
+			}
+		}
+		return i;
+	}
+
+	// Thrown by the transcoders on an invalid or truncated sequence, with the position of its first code unit in the source
+	class encoding_error : public std::range_error {
+	public:
+		encoding_error(char const* what, std::size_t position)
+			: std::range_error(what)
+			, position(position) {
+
+		}
+
+		auto get_position() const noexcept -> std::size_t { return position; }
+
+	private:
+		std::size_t position;
+	};
+
+	namespace detail {
+		// The encoding of a character type follows from its size: UTF-8, UTF-16, or UTF-32, like wchar_t on most targets
+		template<typename CharT>
+		auto get_code_unit(CharT c) noexcept -> std::uint32_t {
+			static_assert(sizeof(CharT) == 1 || sizeof(CharT) == 2 || sizeof(CharT) == 4, "Code units are UTF-8, UTF-16 or UTF-32");
+			return static_cast<std::uint32_t>(static_cast<std::make_unsigned_t<CharT>>(c));
+		}
+
+		// Position of the first code unit at or after pos which is not ASCII, or size, for code units of any size
+		template<typename CharT>
+		auto find_non_ascii_unit(CharT const* str, std::size_t size, std::size_t pos) noexcept -> std::size_t {
+			if constexpr(sizeof(CharT) == 1) {
+				return find_non_ascii(reinterpret_cast<unsigned char const*>(str), size, pos);
+			} else {
+				std::size_t i = pos;
+#ifdef SHARED_STRING_SSE2
+				// A code unit is ASCII if all of its bits above the lowest 7 are zero
+				__m128i const high_bits = sizeof(CharT) == 2 ? _mm_set1_epi16(static_cast<short>(0xFF80)) : _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+				for(; i + 16 / sizeof(CharT) <= size; i += 16 / sizeof(CharT)) {
+					__m128i const zero_bytes = _mm_cmpeq_epi8(_mm_and_si128(load_chars(str + i), high_bits), _mm_setzero_si128());
+					unsigned const mask = ~static_cast<unsigned>(_mm_movemask_epi8(zero_bytes)) & 0xFFFF;
+					if(mask != 0) {
+						return i + count_trailing_zeros(mask) / sizeof(CharT);
+					}
+				}
+#endif
+				for(; i < size; ++i) {
+					if(get_code_unit(str[i]) >= 0x80) {
+						return i;
+					}
+				}
+				return size;
+			}
+		}
+
+		// Copies count ASCII code units to out, changing their size
+		template<typename To, typename From>
+		auto copy_ascii(From const* str, std::size_t count, To* out) noexcept -> To* {
+			if constexpr(sizeof(From) == sizeof(To)) {
+				std::memcpy(out, str, count * sizeof(To));
+				return out + count;
+			} else {
+				std::size_t i = 0;
+#ifdef SHARED_STRING_SSE2
+				auto const store = [&](std::size_t at, __m128i units) { _mm_storeu_si128(reinterpret_cast<__m128i*>(out + at), units); };
+				auto const load = [&](std::size_t at) { return load_chars(str + at); };
+				if constexpr(sizeof(From) == 1) {
+					// Interleaving with zero bytes widens the code units
+					__m128i const zero = _mm_setzero_si128();
+					for(; i + 16 <= count; i += 16) {
+						__m128i const low = _mm_unpacklo_epi8(load(i), zero);
+						__m128i const high = _mm_unpackhi_epi8(load(i), zero);
+						if constexpr(sizeof(To) == 2) {
+							store(i, low);
+							store(i + 8, high);
+						} else {
+							store(i, _mm_unpacklo_epi16(low, zero));
+							store(i + 4, _mm_unpackhi_epi16(low, zero));
+							store(i + 8, _mm_unpacklo_epi16(high, zero));
+							store(i + 12, _mm_unpackhi_epi16(high, zero));
+						}
+					}
+				} else if constexpr(sizeof(To) == 1) {
+					// ASCII fits in a signed byte, so packing with signed saturation keeps the code units as they are
+					for(; i + 16 <= count; i += 16) {
+						if constexpr(sizeof(From) == 2) {
+							store(i, _mm_packs_epi16(load(i), load(i + 8)));
+						} else {
+							store(i, _mm_packs_epi16(_mm_packs_epi32(load(i), load(i + 4)), _mm_packs_epi32(load(i + 8), load(i + 12))));
+						}
+					}
+				}
+#endif
+				for(; i < count; ++i) {
+					out[i] = static_cast<To>(get_code_unit(str[i]));
+				}
+				return out + count;
+			}
+		}
+
+		// Decodes the code point starting at pos, returning the number of code units it takes, or 0 if they are invalid or truncated
+		template<typename CharT>
+		auto decode_code_point(CharT const* str, std::size_t size, std::size_t pos, std::uint32_t& code_point) noexcept -> std::size_t {
+			std::uint32_t const unit = get_code_unit(str[pos]);
+			if constexpr(sizeof(CharT) == 1) {
+				if(unit < 0x80) {
+					code_point = unit;
+					return 1;
+				}
+				auto const bytes = reinterpret_cast<unsigned char const*>(str) + pos;
+				std::size_t const length = get_utf8_sequence_length(bytes, size - pos);
+				if(length == 2) {
+					code_point = (unit & 0x1Fu) << 6 | (bytes[1] & 0x3Fu);
+				} else if(length == 3) {
+					code_point = (unit & 0x0Fu) << 12 | (bytes[1] & 0x3Fu) << 6 | (bytes[2] & 0x3Fu);
+				} else if(length == 4) {
+					code_point = (unit & 0x07u) << 18 | (bytes[1] & 0x3Fu) << 12 | (bytes[2] & 0x3Fu) << 6 | (bytes[3] & 0x3Fu);
+				}
+				return length;
+			} else if constexpr(sizeof(CharT) == 2) {
+				if(unit < 0xD800 || unit > 0xDFFF) {
+					code_point = unit;
+					return 1;
+				}
+				// A high surrogate must be followed by a low one
+				if(unit <= 0xDBFF && pos + 1 < size) {
+					std::uint32_t const low = get_code_unit(str[pos + 1]);
+					if(low >= 0xDC00 && low <= 0xDFFF) {
+						code_point = 0x10000 + ((unit - 0xD800) << 10 | (low - 0xDC00));
+						return 2;
+					}
+				}
+				return 0;
+			} else {
+				code_point = unit;
+				return unit <= 0x10FFFF && (unit < 0xD800 || unit > 0xDFFF) ? 1 : 0;
+			}
+		}
+
+		template<typename CharT>
+		constexpr auto get_encoded_length(std::uint32_t code_point) noexcept -> std::size_t {
+			if constexpr(sizeof(CharT) == 1) {
+				return code_point < 0x80 ? 1 : code_point < 0x800 ? 2 : code_point < 0x10000 ? 3 : 4;
+			} else if constexpr(sizeof(CharT) == 2) {
+				return code_point < 0x10000 ? 1 : 2;
+			} else {
+				return 1;
+			}
+		}
+
+		template<typename CharT>
+		auto encode_code_point(std::uint32_t code_point, CharT* out) noexcept -> CharT* {
+			if constexpr(sizeof(CharT) == 1) {
+				if(code_point < 0x80) {
+					*out++ = static_cast<CharT>(code_point);
+				} else if(code_point < 0x800) {
+					*out++ = static_cast<CharT>(0xC0 | code_point >> 6);
+					*out++ = static_cast<CharT>(0x80 | (code_point & 0x3F));
+				} else if(code_point < 0x10000) {
+					*out++ = static_cast<CharT>(0xE0 | code_point >> 12);
+					*out++ = static_cast<CharT>(0x80 | (code_point >> 6 & 0x3F));
+					*out++ = static_cast<CharT>(0x80 | (code_point & 0x3F));
+				} else {
+					*out++ = static_cast<CharT>(0xF0 | code_point >> 18);
+					*out++ = static_cast<CharT>(0x80 | (code_point >> 12 & 0x3F));
+					*out++ = static_cast<CharT>(0x80 | (code_point >> 6 & 0x3F));
+					*out++ = static_cast<CharT>(0x80 | (code_point & 0x3F));
+				}
+			} else if constexpr(sizeof(CharT) == 2) {
+				if(code_point < 0x10000) {
+					*out++ = static_cast<CharT>(code_point);
+				} else {
+					*out++ = static_cast<CharT>(0xD800 + ((code_point - 0x10000) >> 10));
+					*out++ = static_cast<CharT>(0xDC00 + ((code_point - 0x10000) & 0x3FF));
+				}
+			} else {
+				*out++ = static_cast<CharT>(code_point);
+			}
+			return out;
+		}
+
+		// Calls ascii(position, count) for each run of ASCII code units, and other(position, length, code_point) for each other code point
+		// Returns the position of the first invalid or truncated sequence, or size if the code units are valid
+		template<typename CharT, typename Ascii, typename Other>
+		auto for_each_run(CharT const* str, std::size_t size, Ascii&& ascii, Other&& other) noexcept -> std::size_t {
+			std::size_t i = 0;
+			while(i < size) {
+				std::size_t const run_end = find_non_ascii_unit(str, size, i);
+				ascii(i, run_end - i);
+				// Outside ASCII text, like CJK, most code points follow one another, so runs are only searched after an ASCII code unit
+				for(i = run_end; i < size && get_code_unit(str[i]) >= 0x80;) {
+					std::uint32_t code_point = 0;
+					std::size_t const length = decode_code_point(str, size, i, code_point);
+					if(length == 0) {
+						return i;
+					}
+					other(i, length, code_point);
+					i += length;
+				}
+			}
+			return size;
+		}
+
+		template<typename CharT, typename Allocator>
+		using transcoded_string = basic_shared_string<CharT, std::char_traits<CharT>, typename std::allocator_traits<Allocator>::template rebind_alloc<CharT>>;
+	}
+
+	// Converts between strings of UTF-8, UTF-16 and UTF-32 code units, like shared_string, shared_u16string and shared_u32string
+	// A first pass validates the source and computes the exact size of the result, and a second pass writes the result
+	// directly into a single block of that size. Runs of ASCII are found and converted a vector at a time
+	// A UTF-8 result is known to be valid, and whether it is ASCII, from the flags of its block
+	// Throws: encoding_error at the first invalid or truncated sequence of the source
+	template<typename Target, typename CharT, typename Traits, typename Allocator>
+	auto transcode(basic_shared_string<CharT, Traits, Allocator> const& s, typename Target::allocator_type const& alloc = typename Target::allocator_type()) -> Target {
+		using target_char = typename Target::value_type;
+		CharT const* const str = s.data();
+
+		std::size_t size = 0;
+		bool ascii = true;
+		std::size_t const invalid = detail::for_each_run(str, s.size(),
+			[&](std::size_t, std::size_t count) { size += count; },
+			[&](std::size_t, std::size_t, std::uint32_t code_point) {
+				size += detail::get_encoded_length<target_char>(code_point);
+				ascii = false;
+			});
+		if(invalid != s.size()) {
+			throw encoding_error("Invalid or truncated code unit sequence", invalid);
+		}
+
+		Target result = detail::bulk_access::make_written<Target>(size, alloc, [&](target_char* out) noexcept {
+			detail::for_each_run(str, s.size(),
+				[&](std::size_t position, std::size_t count) { out = detail::copy_ascii(str + position, count, out); },
+				[&](std::size_t, std::size_t, std::uint32_t code_point) { out = detail::encode_code_point(code_point, out); });
+		});
+		if constexpr(sizeof(target_char) == 1) {
+			if(auto const flags = detail::flags_access::get(result)) {
+				flags->fetch_or(detail::block_utf8_known | detail::block_is_utf8 | detail::block_ascii_known | (ascii ? detail::block_is_ascii : 0u), std::memory_order_relaxed);
+			}
+		}
+		return result;
+	}
+
+	// Transcodes into a string of the given encoding, allocated with the source's allocator
+	template<typename CharT, typename Traits, typename Allocator>
+	auto to_utf8(basic_shared_string<CharT, Traits, Allocator> const& s) -> detail::transcoded_string<char, Allocator> {
+		using target = detail::transcoded_string<char, Allocator>;
+		return transcode<target>(s, typename target::allocator_type(s.get_allocator()));
+	}
+	template<typename CharT, typename Traits, typename Allocator>
+	auto to_utf16(basic_shared_string<CharT, Traits, Allocator> const& s) -> detail::transcoded_string<char16_t, Allocator> {
+		using target = detail::transcoded_string<char16_t, Allocator>;
+		return transcode<target>(s, typename target::allocator_type(s.get_allocator()));
+	}
+	template<typename CharT, typename Traits, typename Allocator>
+	auto to_utf32(basic_shared_string<CharT, Traits, Allocator> const& s) -> detail::transcoded_string<char32_t, Allocator> {
+		using target = detail::transcoded_string<char32_t, Allocator>;
+		return transcode<target>(s, typename target::allocator_type(s.get_allocator()));
+	}
+}
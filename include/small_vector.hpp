@@ -0,0 +1,236 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "shared_string.hpp"
+
+#include <memory>
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+#include <cstddef>
+#include <cassert>
+
+namespace kab
+{
+	// Vector storing up to N elements inline before allocating
+	// Growing, and moving a vector whose elements are inline, relocate the elements with memcpy when is_trivially_relocatable
+	// holds for T, like for basic_shared_string, instead of move constructing then destroying each of them
+	template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+	class small_vector : private Allocator {
+		using alloc_traits = std::allocator_traits<Allocator>;
+		static constexpr bool relocates_nothrow = is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>;
+	public:
+		using value_type = T;
+		using allocator_type = Allocator;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference = T&;
+		using const_reference = T const&;
+		using pointer = T*;
+		using const_pointer = T const*;
+		using iterator = T*;
+		using const_iterator = T const*;
+
+		small_vector() noexcept(noexcept(Allocator())) = default;
+		explicit small_vector(Allocator const& alloc) noexcept
+			: Allocator(alloc) {
+
+		}
+		// Delegates to another constructor, so that the destructor frees what was copied if copying an element throws
+		small_vector(small_vector const& other)
+			: small_vector(alloc_traits::select_on_container_copy_construction(other.access_allocator())) {
+			reserve(other.size());
+			for(T const& value : other) {
+				push_back(value);
+			}
+		}
+		small_vector(small_vector && other) noexcept(relocates_nothrow)
+			: Allocator(std::move(other.access_allocator())) {
+			take(other);
+		}
+		auto operator=(small_vector const& other) -> small_vector & {
+			if(this != &other) {
+				clear();
+				if constexpr(alloc_traits::propagate_on_container_copy_assignment::value) {
+					if(!alloc_traits::is_always_equal::value && access_allocator() != other.access_allocator()) {
+						deallocate_heap();
+					}
+					access_allocator() = other.access_allocator();
+				}
+				reserve(other.size());
+				for(T const& value : other) {
+					push_back(value);
+				}
+			}
+			return *this;
+		}
+		auto operator=(small_vector && other) noexcept(relocates_nothrow && (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)) -> small_vector & {
+			if(this != &other) {
+				clear();
+				deallocate_heap();
+				if constexpr(alloc_traits::propagate_on_container_move_assignment::value) {
+					access_allocator() = std::move(other.access_allocator());
+					take(other);
+				} else if(alloc_traits::is_always_equal::value || access_allocator() == other.access_allocator()) {
+					take(other);
+				} else {
+					// The other's buffer cannot be freed with this allocator, so the elements are moved one by one
+					reserve(other.size());
+					for(T& value : other) {
+						push_back(std::move(value));
+					}
+					other.clear();
+				}
+			}
+			return *this;
+		}
+		~small_vector() {
+			clear();
+			deallocate_heap();
+		}
+
+		template<typename... Args>
+		auto emplace_back(Args&&... args) -> reference {
+			if(size_ == capacity_) {
+				// The new element is constructed before relocating the others, in case args refer to one of them
+				size_type const new_capacity = (std::max)(capacity_ * 2, size_type(1));
+				T* const new_data = alloc_traits::allocate(access_allocator(), new_capacity);
+				try {
+					alloc_traits::construct(access_allocator(), new_data + size_, std::forward<Args>(args)...);
+				} catch(...) {
+					alloc_traits::deallocate(access_allocator(), new_data, new_capacity);
+					throw;
+				}
+				try {
+					relocate(data_, size_, new_data);
+				} catch(...) {
+					alloc_traits::destroy(access_allocator(), new_data + size_);
+					alloc_traits::deallocate(access_allocator(), new_data, new_capacity);
+					throw;
+				}
+				adopt_storage(new_data, new_capacity);
+			} else {
+				alloc_traits::construct(access_allocator(), data_ + size_, std::forward<Args>(args)...);
+			}
+			return data_[size_++];
+		}
+		void push_back(T const& value) { emplace_back(value); }
+		void push_back(T && value) { emplace_back(std::move(value)); }
+		void pop_back() noexcept {
+			assert(size_ > 0 && "pop_back on an empty small_vector");
+			alloc_traits::destroy(access_allocator(), data_ + --size_);
+		}
+		void clear() noexcept {
+			for(size_type i = 0; i < size_; ++i) {
+				alloc_traits::destroy(access_allocator(), data_ + i);
+			}
+			size_ = 0;
+		}
+		void reserve(size_type new_capacity) {
+			if(new_capacity > capacity_) {
+				replace_storage(alloc_traits::allocate(access_allocator(), new_capacity), new_capacity);
+			}
+		}
+
+		auto operator[](size_type index) noexcept -> reference { return data_[index]; }
+		auto operator[](size_type index) const noexcept -> const_reference { return data_[index]; }
+		auto front() noexcept -> reference { return data_[0]; }
+		auto front() const noexcept -> const_reference { return data_[0]; }
+		auto back() noexcept -> reference { return data_[size_ - 1]; }
+		auto back() const noexcept -> const_reference { return data_[size_ - 1]; }
+		auto data() noexcept -> pointer { return data_; }
+		auto data() const noexcept -> const_pointer { return data_; }
+		auto begin() noexcept -> iterator { return data_; }
+		auto begin() const noexcept -> const_iterator { return data_; }
+		auto end() noexcept -> iterator { return data_ + size_; }
+		auto end() const noexcept -> const_iterator { return data_ + size_; }
+
+		auto size() const noexcept -> size_type { return size_; }
+		auto capacity() const noexcept -> size_type { return capacity_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+		auto get_allocator() const noexcept -> allocator_type { return access_allocator(); }
+		// Whether the elements are in the vector's inline storage
+		bool is_inline() const noexcept { return data_ == inline_data(); }
+
+	private:
+		auto access_allocator() & noexcept -> Allocator & { return *this; }
+		auto access_allocator() const& noexcept -> Allocator const& { return *this; }
+
+		auto inline_data() noexcept -> T* { return reinterpret_cast<T*>(inline_storage); }
+		auto inline_data() const noexcept -> T const* { return reinterpret_cast<T const*>(inline_storage); }
+
+		// Moves count elements to uninitialized storage, leaving the source storage without live elements
+		void relocate(T* from, size_type count, T* to) noexcept(relocates_nothrow) {
+			if constexpr(is_trivially_relocatable_v<T>) {
+				if(count != 0) {
+					std::memcpy(static_cast<void*>(to), static_cast<void const*>(from), count * sizeof(T));
+				}
+			} else if constexpr(std::is_nothrow_move_constructible_v<T>) {
+				for(size_type i = 0; i < count; ++i) {
+					alloc_traits::construct(access_allocator(), to + i, std::move(from[i]));
+					alloc_traits::destroy(access_allocator(), from + i);
+				}
+			} else {
+				size_type constructed = 0;
+				try {
+					for(; constructed < count; ++constructed) {
+						alloc_traits::construct(access_allocator(), to + constructed, std::move_if_noexcept(from[constructed]));
+					}
+				} catch(...) {
+					for(size_type i = 0; i < constructed; ++i) {
+						alloc_traits::destroy(access_allocator(), to + i);
+					}
+					throw;
+				}
+				for(size_type i = 0; i < count; ++i) {
+					alloc_traits::destroy(access_allocator(), from + i);
+				}
+			}
+		}
+		void replace_storage(T* new_data, size_type new_capacity) {
+			if constexpr(relocates_nothrow) {
+				relocate(data_, size_, new_data);
+			} else {
+				try {
+					relocate(data_, size_, new_data);
+				} catch(...) {
+					alloc_traits::deallocate(access_allocator(), new_data, new_capacity);
+					throw;
+				}
+			}
+			adopt_storage(new_data, new_capacity);
+		}
+		// Requires: the elements were relocated to new_data
+		void adopt_storage(T* new_data, size_type new_capacity) noexcept {
+			deallocate_heap();
+			data_ = new_data;
+			capacity_ = new_capacity;
+		}
+		void deallocate_heap() noexcept {
+			if(!is_inline()) {
+				alloc_traits::deallocate(access_allocator(), data_, capacity_);
+				data_ = inline_data();
+				capacity_ = N;
+			}
+		}
+		// Requires: this vector is empty and inline, and other's storage can be freed with this allocator
+		void take(small_vector& other) noexcept(relocates_nothrow) {
+			if(other.is_inline()) {
+				relocate(other.data_, other.size_, data_);
+			} else {
+				data_ = std::exchange(other.data_, other.inline_data());
+				capacity_ = std::exchange(other.capacity_, N);
+			}
+			size_ = std::exchange(other.size_, 0);
+		}
+
+		T* data_ = inline_data();
+		size_type size_ = 0;
+		size_type capacity_ = N;
+		alignas(T) unsigned char inline_storage[sizeof(T) * (N > 0 ? N : 1)];
+	};
+}
@@ -6,6 +6,13 @@
 
 #include <shared_string.hpp>
 
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
 namespace {
 	struct counting_block {
 		counting_block(size_t i) : identity(i) {}
@@ -72,6 +79,54 @@ namespace {
 
 	using counting_string = kab::basic_shared_string<char, std::char_traits<char>, counting_allocator<char>>;
 
+	// Allocator whose construct throws once it has constructed a given number of values
+	template<typename T>
+	class limited_construct_allocator {
+		template<typename>
+		friend class limited_construct_allocator;
+	public:
+		using value_type = T;
+
+		limited_construct_allocator() = default;
+		template<typename U>
+		limited_construct_allocator(limited_construct_allocator<U> const& other) noexcept
+			: remaining(other.remaining)
+			, live(other.live) {
+
+		}
+
+		T* allocate(std::size_t n) {
+			++*live;
+			return std::allocator<T>().allocate(n);
+		}
+		void deallocate(T* ptr, std::size_t n) noexcept {
+			--*live;
+			std::allocator<T>().deallocate(ptr, n);
+		}
+		template<typename U>
+		void construct(U* ptr, U const& value) {
+			if(*remaining == 0) {
+				throw std::runtime_error("Construction limit reached");
+			}
+			--*remaining;
+			new(ptr) U(value);
+		}
+
+		friend bool operator==(limited_construct_allocator const& lhs, limited_construct_allocator const& rhs) {
+			return lhs.live == rhs.live;
+		}
+		friend bool operator!=(limited_construct_allocator const& lhs, limited_construct_allocator const& rhs) {
+			return lhs.live != rhs.live;
+		}
+
+		void set_remaining(std::size_t count) noexcept { *remaining = count; }
+		std::size_t get_live_allocations() const noexcept { return *live; }
+
+	private:
+		std::shared_ptr<std::size_t> remaining = std::make_shared<std::size_t>(0);
+		std::shared_ptr<std::size_t> live = std::make_shared<std::size_t>(0);
+	};
+
 	template<typename T>
 	class non_propagating_allocator
 	{
@@ -523,7 +578,7 @@ TEST_CASE("Shared String Value Swap", "[string]") {
 TEST_CASE("Shared String Literal", "[string]") {
 	using namespace kab::literals;
 
-	auto const s = "Hello, World!"_ss;
+	kab::shared_string const s = "Hello, World!"_ss;
 
 	test_value(s, "Hello, World!");
 
@@ -542,4 +597,584 @@ TEST_CASE("Shared String Literal", "[string]") {
 	s2 = std::move(s3);
 
 	test_value(s3, "Goodbye, Cruel World");
-}
\ No newline at end of file
+}
+TEST_CASE("Shared String Substr", "[string]") {
+	counting_string const value("Hello, World!");
+	auto const allocator = value.get_allocator();
+	auto const alloc_count = allocator.get_alloc_count();
+
+	auto const world = value.substr(7, 5);
+	test_value(world, "World");
+	REQUIRE(world.data() == value.data() + 7);
+	REQUIRE(allocator.get_alloc_count() == alloc_count);
+
+	test_value(value.substr(7), "World!");
+	test_value(world.substr(1, 100), "orld");
+	REQUIRE(value.substr(13).empty());
+	REQUIRE_THROWS_AS(value.substr(14), std::out_of_range);
+
+	{
+		auto const hello = value.substr(0, 5);
+		test_value(hello, "Hello");
+	}
+	REQUIRE(allocator.get_current_alloc() == 1);
+}
+
+TEST_CASE("Shared String Substr Outlives Source", "[string]") {
+	counting_string::allocator_type allocator;
+	{
+		counting_string world;
+		{
+			counting_string const value("Hello, World!", allocator);
+			world = value.substr(7, 5);
+		}
+		test_value(world, "World");
+		REQUIRE(allocator.get_current_alloc() == 1);
+	}
+	REQUIRE(allocator.get_current_alloc() == 0);
+}
+
+TEST_CASE("Shared String Fill", "[string]") {
+	kab::shared_string const s(5, 'x');
+	test_value(s, "xxxxx");
+}
+
+TEST_CASE("Shared String Slab", "[string]") {
+	std::vector<std::string_view> const fields = { "GET", "/index.html", "", "HTTP/1.1" };
+	counting_string::allocator_type allocator;
+
+	{
+		auto const strings = kab::make_shared_strings<counting_string>(fields.begin(), fields.end(), allocator);
+		REQUIRE(allocator.get_alloc_count() == 1);
+		REQUIRE(strings.size() == 4);
+		test_value(strings[0], "GET");
+		test_value(strings[1], "/index.html");
+		REQUIRE(strings[2].empty());
+		test_value(strings[3], "HTTP/1.1");
+		REQUIRE(strings[1].data() == strings[0].data() + 3);
+
+		auto const kept = strings[3];
+		auto const versions = strings[3].substr(5);
+		REQUIRE(allocator.get_current_alloc() == 1);
+	}
+	REQUIRE(allocator.get_current_alloc() == 0);
+
+	std::vector<std::string> const none;
+	REQUIRE(kab::make_shared_strings(none.begin(), none.end()).empty());
+}
+
+TEST_CASE("Shared String Slab Throwing Construction", "[string]") {
+	using string_type = kab::basic_shared_string<char, std::char_traits<char>, limited_construct_allocator<char>>;
+	std::vector<std::string_view> const fields = { "GET", "/index.html", "HTTP/1.1" };
+	limited_construct_allocator<char> allocator;
+
+	// Fails in the middle of the second field
+	allocator.set_remaining(8);
+	REQUIRE_THROWS_AS(kab::make_shared_strings<string_type>(fields.begin(), fields.end(), allocator), std::runtime_error);
+	REQUIRE(allocator.get_live_allocations() == 0);
+
+	allocator.set_remaining(100);
+	{
+		auto const strings = kab::make_shared_strings<string_type>(fields.begin(), fields.end(), allocator);
+		REQUIRE(strings.size() == 3);
+		REQUIRE(strings[1].view() == "/index.html");
+		REQUIRE(allocator.get_live_allocations() == 1);
+	}
+	REQUIRE(allocator.get_live_allocations() == 0);
+
+#ifdef __cpp_lib_span
+	auto const from_span = kab::make_shared_strings(std::span(fields));
+	REQUIRE(from_span.size() == 3);
+	REQUIRE(from_span[2].view() == "HTTP/1.1");
+	REQUIRE(from_span[2].data() == from_span[0].data() + 14);
+#endif
+}
+
+TEST_CASE("Shared String Share N", "[string]") {
+	counting_string::allocator_type allocator;
+	{
+		std::vector<counting_string> subscribers;
+		{
+			counting_string const message("Hello, World!", allocator);
+			kab::share_n(message.substr(7), 100, std::back_inserter(subscribers));
+		}
+
+		REQUIRE(subscribers.size() == 100);
+		for(auto const& s : subscribers) {
+			test_value(s, "World!");
+			REQUIRE(s.data() == subscribers.front().data());
+			REQUIRE(s.get_allocator() == allocator);
+		}
+		REQUIRE(allocator.get_alloc_count() == 1);
+
+		// Releasing part of the handles leaves the block alive for the others
+		kab::release_shared(subscribers.begin(), subscribers.begin() + 50);
+		REQUIRE(subscribers[0].empty());
+		test_value(subscribers[50], "World!");
+		REQUIRE(allocator.get_current_alloc() == 1);
+
+		kab::release_shared(subscribers.begin() + 50, subscribers.end());
+		REQUIRE(subscribers[99].empty());
+		REQUIRE(allocator.get_current_alloc() == 0);
+	}
+	REQUIRE(allocator.get_dealloc_count() == 1);
+}
+
+namespace {
+	// Output iterator whose assignment throws once it has written limit strings
+	struct limited_output {
+		using iterator_category = std::output_iterator_tag;
+		using value_type = void;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = void;
+
+		std::vector<counting_string>* strings;
+		std::size_t limit;
+
+		auto operator*() -> limited_output & { return *this; }
+		auto operator++() -> limited_output & { return *this; }
+		auto operator++(int) -> limited_output { return *this; }
+		auto operator=(counting_string && s) -> limited_output & {
+			if(strings->size() == limit) {
+				throw std::runtime_error("Output full");
+			}
+			strings->push_back(std::move(s));
+			return *this;
+		}
+	};
+}
+
+TEST_CASE("Shared String Share N Throwing Output", "[string]") {
+	counting_string::allocator_type allocator;
+	{
+		counting_string const message("Hello, World!", allocator);
+		std::vector<counting_string> subscribers;
+		REQUIRE_THROWS_AS(kab::share_n(message, 10, limited_output{ &subscribers, 4 }), std::runtime_error);
+		REQUIRE(subscribers.size() == 4);
+
+		// Only the references of the written handles are left besides the message's own
+		subscribers.clear();
+		REQUIRE(allocator.get_current_alloc() == 1);
+		test_value(message, "Hello, World!");
+	}
+	REQUIRE(allocator.get_current_alloc() == 0);
+	REQUIRE(allocator.get_dealloc_count() == 1);
+}
+
+TEST_CASE("Shared String Share N Literal", "[string]") {
+	using namespace kab::literals;
+
+	std::vector<kab::shared_string> copies(3);
+	kab::share_n(kab::shared_string("Hello, World!"_ss), copies.size(), copies.begin());
+	for(auto const& s : copies) {
+		test_value(s, "Hello, World!");
+	}
+	REQUIRE(kab::share_n(kab::shared_string("unused"_ss), 0, copies.begin()) == copies.begin());
+
+	kab::release_shared(copies.begin(), copies.end());
+	REQUIRE(copies[0].empty());
+}
+
+TEST_CASE("Shared String Release All", "[string]") {
+	using namespace kab::literals;
+
+	counting_string::allocator_type allocator;
+	std::vector<std::string_view> const fields = { "id", "name", "email" };
+
+	std::vector<counting_string> strings;
+	counting_string kept;
+	for(int record = 0; record < 10; ++record) {
+		auto parsed = kab::make_shared_strings<counting_string>(fields.begin(), fields.end(), allocator);
+		strings.insert(strings.end(), parsed.begin(), parsed.end());
+		if(record == 3) {
+			kept = parsed[1];
+		}
+	}
+	strings.emplace_back();
+	REQUIRE(allocator.get_current_alloc() == 10);
+
+	kab::release_all(strings.begin(), strings.end());
+
+	for(auto const& s : strings) {
+		REQUIRE(s.empty());
+	}
+	REQUIRE(allocator.get_current_alloc() == 1); // the block of the kept string is still owned
+	test_value(kept, "name");
+
+	kept.clear();
+	REQUIRE(allocator.get_current_alloc() == 0);
+
+	std::vector<kab::shared_string> literals = { "a"_ss, "b"_ss };
+	kab::release_all(literals.begin(), literals.end());
+	REQUIRE(literals[0].empty());
+}
+
+TEST_CASE("Shared String Ref", "[string]") {
+	counting_string::allocator_type allocator;
+	counting_string const value("Hello, World!", allocator);
+
+	using ref_type = kab::basic_shared_string_ref<char, std::char_traits<char>, counting_allocator<char>>;
+	auto const count_view = [](ref_type ref) { return ref.size(); };
+
+	ref_type const ref = value;
+	REQUIRE(count_view(value) == 13);
+	REQUIRE(ref.data() == value.data());
+	REQUIRE(ref.view() == "Hello, World!");
+
+	auto const world = ref.substr(7, 5);
+	REQUIRE(world.view() == "World");
+	REQUIRE(world == ref_type(value).substr(7, 5));
+	REQUIRE(world != ref);
+
+	counting_string stored;
+	{
+		stored = world.to_shared();
+	}
+	test_value(stored, "World");
+	REQUIRE(stored.data() == value.data() + 7);
+	REQUIRE(stored.get_allocator() == allocator);
+	REQUIRE(allocator.get_alloc_count() == 1);
+}
+
+TEST_CASE("Shared String Ref Outliving Ownership", "[string]") {
+	using namespace kab::literals;
+
+	counting_string::allocator_type allocator;
+	counting_string stored;
+	{
+		counting_string const value("Hello, World!", allocator);
+		kab::basic_shared_string_ref<char, std::char_traits<char>, counting_allocator<char>> const ref = value;
+		stored = ref.to_shared();
+	}
+	test_value(stored, "Hello, World!");
+	REQUIRE(allocator.get_current_alloc() == 1);
+	stored.clear();
+	REQUIRE(allocator.get_current_alloc() == 0);
+
+	kab::shared_string const literal = "literal"_ss;
+	kab::shared_string_ref const literal_ref = literal;
+	test_value(literal_ref.to_shared(), "literal");
+}
+
+TEST_CASE("Share View", "[string]") {
+	using namespace kab::literals;
+
+	counting_string::allocator_type allocator;
+	counting_string const value("Hello, World!", allocator);
+	counting_string const world = value.substr(7, 5);
+	REQUIRE(world.offset_in_block() == 7);
+	REQUIRE(world.block_size() == 13);
+
+	std::string_view const view(value.data(), value.size());
+	auto const hello = value.share(view.substr(0, 5));
+	test_value(hello, "Hello");
+	REQUIRE(hello.data() == value.data());
+	REQUIRE(hello.offset_in_block() == 0);
+
+	// A view may reach outside of the substring, as long as it stays in the block
+	auto const comma = world.share(view.substr(5, 2));
+	test_value(comma, ", ");
+	REQUIRE(comma.data() == value.data() + 5);
+	REQUIRE(allocator.get_alloc_count() == 1);
+
+	REQUIRE(world.share(std::string_view()).empty());
+	std::string const elsewhere = "Hello";
+	REQUIRE_THROWS_AS(value.share(elsewhere), std::out_of_range);
+
+	kab::shared_string const literal = "literal"_ss;
+	REQUIRE(literal.block_size() == 7);
+	REQUIRE(literal.offset_in_block() == 0);
+	test_value(literal.share(std::string_view(literal.data() + 3, 4)), "eral");
+
+	kab::shared_string const none;
+	REQUIRE(none.share(std::string_view()).empty());
+	REQUIRE(none.share(std::string_view(literal.data(), 0)).empty());
+	REQUIRE_THROWS_AS(none.share(elsewhere), std::out_of_range);
+}
+
+TEST_CASE("Cross Allocator Slice", "[string]") {
+	non_propagating_string const value("Hello, World!");
+	auto const world = value.share(std::string_view(value.data() + 7, 5));
+	REQUIRE(world.block_size() == 13);
+
+	// Only the viewed characters are copied to storage from the other allocator
+	auto const test_copy = [&world](non_propagating_string const& s) {
+		test_value(s, "World");
+		REQUIRE(s.data() != world.data());
+		REQUIRE(s.block_size() == 5);
+		REQUIRE(s.offset_in_block() == 0);
+	};
+
+	SECTION("Copy construction") {
+		auto const s = world;
+		test_copy(s);
+	}
+
+	SECTION("Copy assignment") {
+		non_propagating_string s("Previous value");
+		s = world;
+		test_copy(s);
+	}
+
+	SECTION("Move assignment") {
+		non_propagating_string source = value.share(std::string_view(value.data() + 7, 5));
+		non_propagating_string s("Previous value");
+		s = std::move(source);
+		test_copy(s);
+	}
+}
+
+TEST_CASE("Iterators", "[string]") {
+	kab::shared_string const value("Hello, World!");
+
+	REQUIRE(value.end() - value.begin() == 13);
+	REQUIRE(value.begin() == value.data());
+	REQUIRE(std::string(value.begin(), value.end()) == "Hello, World!");
+	REQUIRE(std::string(value.rbegin(), value.rend()) == "!dlroW ,olleH");
+	REQUIRE(std::count(value.begin(), value.end(), 'o') == 2);
+
+	std::string copy;
+	for(char const c : value.substr(7)) {
+		copy += c;
+	}
+	REQUIRE(copy == "World!");
+
+	kab::shared_string const empty;
+	REQUIRE(empty.begin() == empty.end());
+
+	kab::shared_string_ref const ref = value;
+	REQUIRE(std::equal(ref.begin(), ref.end(), value.begin(), value.end()));
+}
+
+TEST_CASE("String View Conversion", "[string]") {
+	kab::shared_string const value("Hello, World!");
+	auto const take_view = [](std::string_view sv) { return sv; };
+
+	REQUIRE(take_view(value).data() == value.data());
+	REQUIRE(take_view(value) == "Hello, World!");
+	std::string_view const view = value.substr(7, 5);
+	REQUIRE(view == "World");
+	REQUIRE(take_view(kab::shared_string_ref(value)).data() == value.data());
+}
+
+#ifdef __cpp_lib_ranges
+static_assert(std::contiguous_iterator<kab::shared_string::iterator>);
+static_assert(std::ranges::contiguous_range<kab::shared_string>);
+static_assert(std::ranges::sized_range<kab::shared_string>);
+static_assert(!std::ranges::borrowed_range<kab::shared_string>);
+static_assert(std::ranges::contiguous_range<kab::shared_string_ref>);
+static_assert(std::ranges::borrowed_range<kab::shared_string_ref>);
+static_assert(std::ranges::view<kab::shared_string_ref>);
+
+TEST_CASE("Ranges", "[string]") {
+	kab::shared_string const value("Hello, World!");
+
+	REQUIRE(std::ranges::find(value, ',') == value.begin() + 5);
+	REQUIRE(std::ranges::equal(value | std::views::take(5), std::string_view("Hello")));
+
+	// Borrowed, so the iterator found in a temporary reference is still valid
+	auto const it = std::ranges::find(kab::shared_string_ref(value), 'W');
+	REQUIRE(it == value.data() + 7);
+}
+#endif
+
+#if __cpp_constexpr >= 201907L
+namespace {
+	using namespace kab::literals;
+
+	// Constant initialized, so the table costs nothing at startup
+	constexpr kab::shared_string routes[] = { "/"_ss, "/index.html"_ss, "/api/v1/users"_ss };
+
+	static_assert(routes[1].size() == 11);
+	static_assert(routes[1][1] == 'i');
+	static_assert(routes[2].find("v1") == 5);
+	static_assert(routes[2].find('/', 1) == 4);
+	static_assert(routes[2].find('?') == kab::shared_string::npos);
+	static_assert(routes[0] < routes[1]);
+	static_assert(routes[1] == "/index.html"_ss);
+	static_assert(routes[1].compare("/index.htm") > 0);
+	static_assert(std::hash<kab::shared_string>()(routes[0]) == kab::detail::hash_characters<std::char_traits<char>>("/", 1));
+}
+
+TEST_CASE("Constant Literals", "[string]") {
+	REQUIRE(routes[2] == kab::shared_string("/api/v1/users"));
+	REQUIRE(std::hash<kab::shared_string>()(routes[1]) == std::hash<kab::shared_string>()(kab::shared_string("/index.html")));
+}
+#endif
+
+TEST_CASE("Find", "[string]") {
+	kab::shared_string const value("Hello, World!");
+	REQUIRE(value.find("World") == 7);
+	REQUIRE(value.find('o') == 4);
+	REQUIRE(value.find('o', 5) == 8);
+	REQUIRE(value.find(kab::shared_string("xyz")) == kab::shared_string::npos);
+	REQUIRE(value.substr(7).find("World") == 0);
+}
+
+namespace {
+	// Counts the strings and views it hashes, to tell which lookups hash characters
+	struct counting_hash : kab::shared_string_hash {
+		using kab::shared_string_hash::operator();
+
+		auto operator()(kab::shared_string const& s) const noexcept -> std::size_t {
+			++*hashed;
+			return kab::shared_string_hash::operator()(s);
+		}
+		auto operator()(std::string_view s) const noexcept -> std::size_t {
+			++*hashed;
+			return kab::shared_string_hash::operator()(s);
+		}
+
+		std::size_t* hashed;
+	};
+}
+
+TEST_CASE("Literal Hash", "[string]") {
+	using namespace kab::literals;
+
+	// A literal key converts to the literal string it names, which can be assigned any other string
+	constexpr auto key = "content-type"_ss;
+	static_assert(std::is_same_v<decltype(key), kab::literal_key const>);
+	kab::shared_string literal = key;
+	test_value(literal, "content-type");
+	REQUIRE(literal.data() == key.data());
+	literal = kab::shared_string("accept");
+	test_value(literal, "accept");
+
+	REQUIRE(key.hash() == std::hash<kab::shared_string>()(kab::shared_string("content-type")));
+	REQUIRE((u"content-type"_ss).hash() == std::hash<kab::shared_u16string>()(kab::shared_u16string(std::u16string_view(u"content-type"))));
+	REQUIRE((""_ss).hash() == std::hash<kab::shared_string>()(kab::shared_string()));
+	REQUIRE(kab::shared_string_hash()(std::string_view("content-type")) == key.hash());
+
+	// Looking up a literal key takes its hash instead of hashing its characters
+	std::size_t hashed = 0;
+	std::unordered_map<kab::shared_string, int, counting_hash, std::equal_to<>> headers(8, counting_hash{ {}, &hashed });
+	headers.emplace(kab::shared_string("content-type"), 1);
+	headers.emplace("content-length"_ss, 2);
+	hashed = 0;
+	REQUIRE(headers.find("content-length"_ss)->second == 2);
+	REQUIRE(headers.find(key)->second == 1);
+	REQUIRE(headers.find("accept"_ss) == headers.end());
+	REQUIRE(hashed == 0);
+	REQUIRE(headers.find(std::string_view("content-type"))->second == 1);
+	REQUIRE(hashed == 1);
+
+#if __cpp_nontype_template_args >= 201911L
+	REQUIRE(kab::literal_hash<"content-type"> == key.hash());
+	REQUIRE(kab::literal_hash<u"content-type"> == (u"content-type"_ss).hash());
+#endif
+}
+
+#if __cpp_nontype_template_args >= 201911L
+static_assert(kab::literal_hash<"content-type"> == kab::detail::hash_characters<std::char_traits<char>>("content-type", 12));
+static_assert(kab::shared_string_hash()(kab::literals::operator""_ss<"content-type">()) == kab::literal_hash<"content-type">);
+#endif
+
+#if __cpp_constexpr >= 201907L
+namespace {
+	constexpr auto mime_types = kab::make_static_strings("text/html", "application/json", "image/png");
+	static_assert(mime_types.size() == 3);
+	static_assert(mime_types[1].size() == 16);
+	static_assert(mime_types[1].find('/') == 11);
+
+	constexpr char status_text[] = "Not Found";
+	constexpr auto not_found = kab::shared_string::from_static(status_text);
+	static_assert(not_found.data() == status_text);
+}
+
+TEST_CASE("Static Strings", "[string]") {
+	test_value(mime_types[0], "text/html");
+	test_value(not_found, "Not Found");
+
+	// Substrings and copies of static strings share their characters, like those of heap strings
+	auto const subtype = mime_types[1].substr(12);
+	test_value(subtype, "json");
+	REQUIRE(subtype.data() == mime_types[1].data() + 12);
+	REQUIRE(mime_types[1].share(std::string_view(mime_types[1].data(), 11)).data() == mime_types[1].data());
+	REQUIRE(std::hash<kab::shared_string>()(mime_types[2]) == std::hash<kab::shared_string>()(kab::shared_string("image/png")));
+
+	auto const counted = counting_string::from_static("static");
+	counting_string copy(counted);
+	copy = counted.substr(1);
+	test_value(copy, "tatic");
+	REQUIRE(copy.get_allocator().get_alloc_count() == 0);
+}
+#endif
+
+#if __cpp_nontype_template_args >= 201911L
+namespace {
+	constexpr auto& latency_key = kab::literal_concat<"svc.", "latency">;
+	static_assert(std::is_same_v<decltype(latency_key), kab::shared_string const&>);
+	static_assert(latency_key.size() == 11);
+	static_assert(latency_key == kab::shared_string::from_static("svc.latency"));
+	static_assert(kab::literal_concat<u"a", u"", u"bc">.size() == 3);
+}
+
+TEST_CASE("Literal Concatenation", "[string]") {
+	test_value(latency_key, "svc.latency");
+	// The same concatenation is the same static storage
+	REQUIRE(latency_key.data() == kab::literal_concat<"svc.", "latency">.data());
+
+	auto const prefix = latency_key.substr(0, 3);
+	REQUIRE(prefix.data() == latency_key.data());
+	REQUIRE(kab::literal_concat<"svc.", "errors", ".count">.view() == "svc.errors.count");
+}
+#endif
+
+namespace {
+	// Custom traits considering ASCII letters of different case equal, which must not take the byte-wise paths
+	struct case_insensitive_traits : std::char_traits<char> {
+		static auto to_lower(char c) noexcept -> char {
+			return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+		}
+		static bool eq(char lhs, char rhs) noexcept { return to_lower(lhs) == to_lower(rhs); }
+		static bool lt(char lhs, char rhs) noexcept { return to_lower(lhs) < to_lower(rhs); }
+		static int compare(char const* lhs, char const* rhs, std::size_t count) noexcept {
+			for(std::size_t i = 0; i < count; ++i) {
+				if(lt(lhs[i], rhs[i])) return -1;
+				if(lt(rhs[i], lhs[i])) return 1;
+			}
+			return 0;
+		}
+		static char const* find(char const* p, std::size_t count, char const& ch) noexcept {
+			for(std::size_t i = 0; i < count; ++i) {
+				if(eq(p[i], ch)) return p + i;
+			}
+			return nullptr;
+		}
+	};
+
+	using case_insensitive_string = kab::basic_shared_string<char, case_insensitive_traits>;
+	using case_insensitive_view = std::basic_string_view<char, case_insensitive_traits>;
+}
+
+static_assert(kab::detail::has_standard_traits_v<char, std::char_traits<char>>);
+static_assert(kab::detail::has_standard_traits_v<char16_t, std::char_traits<char16_t>>);
+static_assert(!kab::detail::has_standard_traits_v<char, case_insensitive_traits>);
+static_assert(kab::detail::constructs_by_copy_v<std::allocator<char>, char>);
+static_assert(kab::detail::constructs_by_copy_v<counting_allocator<char>, char>);
+
+TEST_CASE("Standard Traits Paths", "[string]") {
+	kab::shared_u16string const value(std::u16string_view(u"Hello, World!"));
+	REQUIRE(value == kab::shared_u16string(std::u16string_view(u"Hello, World!")));
+	REQUIRE(value != kab::shared_u16string(std::u16string_view(u"Hello, World?")));
+	REQUIRE(value.substr(7, 5) == kab::shared_u16string(std::u16string_view(u"World")));
+	REQUIRE(value.find(u'W') == 7);
+	REQUIRE(kab::shared_u16string() == kab::shared_u16string(std::u16string_view()));
+
+	std::vector<std::string> const values = { "first", "", "third" };
+	auto const strings = kab::make_shared_strings(values.begin(), values.end());
+	REQUIRE(strings[0] == kab::shared_string("first"));
+	REQUIRE(strings[1].empty());
+	REQUIRE(strings[2] == kab::shared_string("third"));
+}
+
+TEST_CASE("Custom Traits Paths", "[string]") {
+	case_insensitive_string const value(case_insensitive_view("Hello, World!"));
+	REQUIRE(value == case_insensitive_string(case_insensitive_view("HELLO, world!")));
+	REQUIRE(value != case_insensitive_string(case_insensitive_view("HELLO, world?")));
+	REQUIRE(value.compare(case_insensitive_string(case_insensitive_view("hello, world!"))) == 0);
+	REQUIRE(value.find('w') == 7);
+	REQUIRE(value.find('O', 5) == 8);
+}
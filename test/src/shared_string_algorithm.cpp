@@ -0,0 +1,135 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <shared_string_algorithm.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+	// Short strings over a small alphabet, so that the input has many duplicates and long common prefixes
+	auto make_random_strings(std::size_t count, unsigned seed) -> std::vector<std::string> {
+		std::mt19937 engine(seed);
+		std::uniform_int_distribution<std::size_t> length(0, 12);
+		std::uniform_int_distribution<int> letter('a', 'd');
+
+		std::vector<std::string> values;
+		values.reserve(count);
+		for(std::size_t i = 0; i < count; ++i) {
+			std::string value(length(engine), '\0');
+			for(auto& c : value) {
+				c = static_cast<char>(letter(engine));
+			}
+			values.push_back(std::move(value));
+		}
+		return values;
+	}
+
+	auto make_shared_strings(std::vector<std::string> const& values) -> std::vector<kab::shared_string> {
+		std::vector<kab::shared_string> strings;
+		strings.reserve(values.size());
+		for(auto const& value : values) {
+			strings.emplace_back(value);
+		}
+		return strings;
+	}
+
+	auto get_data_pointers(std::vector<kab::shared_string> const& strings) -> std::vector<char const*> {
+		std::vector<char const*> pointers;
+		for(auto const& s : strings) {
+			pointers.push_back(s.data());
+		}
+		std::sort(pointers.begin(), pointers.end());
+		return pointers;
+	}
+
+	void require_sorted_as(std::vector<kab::shared_string> const& strings, std::vector<std::string> expected) {
+		std::sort(expected.begin(), expected.end());
+		REQUIRE(std::equal(strings.begin(), strings.end(), expected.begin(), expected.end(), [](auto const& s, auto const& e) {
+			return std::string_view(s.data(), s.size()) == e;
+		}));
+	}
+}
+
+TEST_CASE("String Sort", "[algorithm]") {
+	auto const values = make_random_strings(5000, 42);
+	auto strings = make_shared_strings(values);
+	auto const pointers = get_data_pointers(strings);
+
+	kab::string_sort(strings.begin(), strings.end());
+
+	require_sorted_as(strings, values);
+	REQUIRE(get_data_pointers(strings) == pointers); // the handles moved, the values did not
+}
+
+TEST_CASE("String Sort Small Ranges", "[algorithm]") {
+	using namespace kab::literals;
+
+	std::vector<kab::shared_string> empty;
+	kab::string_sort(empty.begin(), empty.end());
+	REQUIRE(empty.empty());
+
+	std::vector<kab::shared_string> strings = { "b"_ss, ""_ss, "ab"_ss, "a"_ss, "b"_ss };
+	kab::string_sort(strings.begin(), strings.end());
+	require_sorted_as(strings, { "b", "", "ab", "a", "b" });
+}
+
+TEST_CASE("String Sort Parallel", "[algorithm]") {
+	auto const values = make_random_strings(200000, 7);
+	auto strings = make_shared_strings(values);
+	auto const pointers = get_data_pointers(strings);
+
+	kab::parallel_string_sort(strings.begin(), strings.end(), 4);
+
+	require_sorted_as(strings, values);
+	REQUIRE(get_data_pointers(strings) == pointers);
+}
+
+TEST_CASE("Dedup", "[algorithm]") {
+	auto const values = make_random_strings(20000, 3);
+	auto strings = make_shared_strings(values);
+
+	// A duplicate kept alive outside of the range frees nothing when it is replaced
+	std::vector<kab::shared_string> kept;
+
+	std::size_t expected_bytes = 0;
+	std::size_t expected_freed = 0;
+	std::unordered_map<std::string, std::size_t> first_index;
+	for(std::size_t i = 0; i < values.size(); ++i) {
+		if(!first_index.emplace(values[i], i).second) {
+			expected_bytes += values[i].size();
+			if(kept.size() < 100) {
+				kept.push_back(strings[i]);
+			} else {
+				expected_freed += strings[i].block_bytes();
+			}
+		}
+	}
+	REQUIRE(kept.size() == 100);
+	REQUIRE(expected_freed > 0);
+	std::vector<char const*> expected_data;
+	for(auto const& value : values) {
+		expected_data.push_back(strings[first_index[value]].data());
+	}
+
+	auto const result = kab::dedup(strings.begin(), strings.end(), 4);
+
+	REQUIRE(result.duplicates == values.size() - first_index.size());
+	REQUIRE(result.duplicate_bytes == expected_bytes);
+	REQUIRE(result.freed_bytes == expected_freed);
+	for(std::size_t i = 0; i < values.size(); ++i) {
+		REQUIRE(std::string_view(strings[i].data(), strings[i].size()) == values[i]);
+		REQUIRE(strings[i].data() == expected_data[i]);
+	}
+
+	auto const second = kab::dedup(strings.begin(), strings.end(), 4);
+	REQUIRE(second.duplicates == 0);
+	REQUIRE(second.duplicate_bytes == 0);
+	REQUIRE(second.freed_bytes == 0);
+}
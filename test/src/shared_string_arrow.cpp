@@ -0,0 +1,70 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <shared_string_arrow.hpp>
+
+#include <cstring>
+#include <optional>
+#include <string>
+
+namespace {
+	auto get_row(ArrowArray const& array, std::int64_t row) -> std::string_view {
+		auto const offsets = static_cast<std::int64_t const*>(array.buffers[1]);
+		auto const data = static_cast<char const*>(array.buffers[2]);
+		return std::string_view(data + offsets[array.offset + row], static_cast<std::size_t>(offsets[array.offset + row + 1] - offsets[array.offset + row]));
+	}
+}
+
+TEST_CASE("Arrow Schema Export", "[arrow]") {
+	ArrowSchema schema;
+	kab::export_arrow_schema(&schema, "method");
+
+	REQUIRE(std::strcmp(schema.format, "U") == 0);
+	REQUIRE(std::strcmp(schema.name, "method") == 0);
+	REQUIRE(schema.n_children == 0);
+	REQUIRE(schema.release != nullptr);
+
+	schema.release(&schema);
+	REQUIRE(schema.release == nullptr);
+}
+
+TEST_CASE("Arrow Array Export", "[arrow]") {
+	ArrowArray first;
+	ArrowArray second;
+	{
+		std::optional<kab::shared_string_column> column(std::in_place, 3, 16);
+		for(int i = 0; i < 5; ++i) {
+			column->push_back("value" + std::to_string(i));
+		}
+
+		kab::export_arrow_chunk(*column, 0, &first);
+		kab::export_arrow_chunk(*column, 1, &second);
+
+		// The buffers are the column's own storage
+		REQUIRE(first.buffers[2] == column->get_chunk(0).data.data());
+		REQUIRE(first.buffers[1] == column->get_chunk(0).offsets->data());
+
+		// Rows pushed after the export are not part of the array
+		column->push_back("late");
+		REQUIRE(second.length == 2);
+
+		column.reset();
+	}
+
+	REQUIRE(first.length == 3);
+	REQUIRE(first.null_count == 0);
+	REQUIRE(first.n_buffers == 3);
+	REQUIRE(first.buffers[0] == nullptr);
+	REQUIRE(get_row(first, 0) == "value0");
+	REQUIRE(get_row(first, 2) == "value2");
+	REQUIRE(get_row(second, 0) == "value3");
+	REQUIRE(get_row(second, 1) == "value4");
+
+	first.release(&first);
+	second.release(&second);
+	REQUIRE(first.release == nullptr);
+	REQUIRE(second.release == nullptr);
+}
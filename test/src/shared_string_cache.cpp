@@ -0,0 +1,122 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <shared_string_cache.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	using cache = kab::basic_shared_string_cache<kab::shared_string>;
+
+	// Bytes of the block of a string of size characters, header included
+	auto const block_bytes = [](std::size_t size) {
+		return kab::shared_string(std::string(size, 'c')).block_bytes();
+	};
+	auto const entry_charge = [](std::size_t key_size, std::size_t value_size) {
+		return block_bytes(key_size) + block_bytes(value_size);
+	};
+}
+
+TEST_CASE("Cache Hit And Miss", "[cache]") {
+	cache c(1 << 16, 4);
+	kab::shared_string const key("key");
+	kab::shared_string const value("value");
+
+	REQUIRE(!c.find(key).has_value());
+	REQUIRE(c.insert(key, value));
+
+	auto const hit = c.find(kab::shared_string("key"));
+	REQUIRE(hit.has_value());
+	REQUIRE(hit->data() == value.data()); // a hit shares the cached storage
+	REQUIRE(c.size() == 1);
+	REQUIRE(c.used_bytes() == entry_charge(3, 5));
+
+	REQUIRE(c.insert(key, kab::shared_string("other value")));
+	REQUIRE(c.size() == 1);
+	REQUIRE(c.used_bytes() == entry_charge(3, 11));
+
+	REQUIRE(c.erase(key));
+	REQUIRE(!c.erase(key));
+	REQUIRE(!c.find(key).has_value());
+	REQUIRE(c.used_bytes() == 0);
+
+	REQUIRE_THROWS_AS(cache(1 << 16, 0), std::invalid_argument);
+}
+
+TEST_CASE("Cache Eviction", "[cache]") {
+	std::size_t const charge = entry_charge(4, 8);
+	cache c(charge * 4, 1);
+
+	std::vector<kab::shared_string> keys;
+	for(int i = 0; i < 4; ++i) {
+		keys.emplace_back("key" + std::to_string(i));
+		REQUIRE(c.insert(keys.back(), kab::shared_string("value" + std::to_string(100 + i))));
+	}
+	REQUIRE(c.used_bytes() == charge * 4);
+
+	// key0 gets a second chance, so key1 is the one evicted
+	REQUIRE(c.find(keys[0]).has_value());
+	REQUIRE(c.insert(kab::shared_string("key4"), kab::shared_string("value104")));
+
+	REQUIRE(c.size() == 4);
+	REQUIRE(c.used_bytes() == charge * 4);
+	REQUIRE(c.find(keys[0]).has_value());
+	REQUIRE(!c.find(keys[1]).has_value());
+	REQUIRE(c.find(keys[2]).has_value());
+
+	REQUIRE(!c.insert(kab::shared_string(std::string(charge * 4, 'k')), kab::shared_string("value")));
+}
+
+TEST_CASE("Cache Charges Whole Blocks", "[cache]") {
+	cache c(1 << 12, 1);
+
+	// A substring keeps its whole block alive, so a character of a large string is charged the large string
+	std::vector<kab::shared_string> large;
+	for(int i = 0; i < 100; ++i) {
+		large.emplace_back(std::string(1 << 20, 'x'));
+		REQUIRE(!c.insert(kab::shared_string(std::to_string(i)), large.back().substr(0, 1)));
+	}
+	REQUIRE(c.size() == 0);
+	REQUIRE(c.used_bytes() == 0);
+
+	kab::shared_string const small(std::string(100, 'y'));
+	REQUIRE(c.insert(kab::shared_string("key"), small.substr(50, 1)));
+	REQUIRE(c.used_bytes() == block_bytes(3) + small.block_bytes());
+	REQUIRE(small.block_bytes() > 100);
+
+	// Static strings keep no block alive, but their entries still count toward the capacity
+	REQUIRE(c.insert(kab::shared_string::from_static("static key"), kab::shared_string::from_static("static value")));
+	REQUIRE(c.used_bytes() == block_bytes(3) + small.block_bytes() + 2 * sizeof(kab::shared_string));
+}
+
+TEST_CASE("Cache Concurrent Access", "[cache]") {
+	cache c(1 << 12, 8);
+	std::atomic_size_t mismatches{ 0 }; // Catch assertions are not thread-safe
+
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 4; ++t) {
+		threads.emplace_back([&c, &mismatches, t] {
+			for(int i = 0; i < 5000; ++i) {
+				kab::shared_string const key(std::to_string((i * 7 + t) % 300));
+				if(auto const hit = c.find(key)) {
+					if(std::string_view(hit->data(), hit->size()) != "v" + std::string(key.data(), key.size())) {
+						++mismatches;
+					}
+				} else {
+					c.insert(key, kab::shared_string("v" + std::string(key.data(), key.size())));
+				}
+			}
+		});
+	}
+	for(auto& thread : threads) {
+		thread.join();
+	}
+
+	REQUIRE(mismatches == 0);
+	REQUIRE(c.used_bytes() <= 1 << 12);
+}
@@ -0,0 +1,107 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <shared_string_case.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <map>
+
+namespace {
+	// Long enough to go through the vectorized loops and their scalar tails
+	std::string const mixed = "Content-Type: Application/JSON; Charset=UTF-8 \xC3\x89t\xC3\xA9";
+	std::string const lower = "content-type: application/json; charset=utf-8 \xC3\x89t\xC3\xA9";
+}
+
+TEST_CASE("Case Insensitive Equality", "[case]") {
+	kab::shared_string const a(mixed);
+	kab::shared_string const b(lower);
+
+	REQUIRE(kab::iequals(a, b));
+	REQUIRE(kab::icompare(a, b) == 0);
+	REQUIRE(!kab::iequals(a, kab::shared_string(lower.substr(1))));
+	// Only ASCII letters are folded
+	REQUIRE(!kab::iequals(kab::shared_string("\xC3\x89"), kab::shared_string("\xC3\xA9")));
+	REQUIRE(!kab::iequals(kab::shared_string("@"), kab::shared_string("`")));
+
+	for(std::size_t i = 0; i < lower.size(); ++i) {
+		std::string changed = lower;
+		changed[i] = '#';
+		REQUIRE(!kab::iequals(a, kab::shared_string(changed)));
+	}
+}
+
+TEST_CASE("Case Insensitive Ordering", "[case]") {
+	REQUIRE(kab::icompare(kab::shared_string("apple"), kab::shared_string("BANANA")) < 0);
+	REQUIRE(kab::icompare(kab::shared_string("Banana"), kab::shared_string("apple")) > 0);
+	REQUIRE(kab::icompare(kab::shared_string("app"), kab::shared_string("APPLE")) < 0);
+	REQUIRE(kab::icompare(kab::shared_string(std::string(40, 'x') + "B"), kab::shared_string(std::string(40, 'X') + "a")) > 0);
+
+	std::map<kab::shared_string, int, kab::case_insensitive_less> sorted;
+	sorted[kab::shared_string("Beta")] = 2;
+	sorted[kab::shared_string("alpha")] = 1;
+	sorted[kab::shared_string("BETA")] = 3;
+	REQUIRE(sorted.size() == 2);
+	REQUIRE(sorted.begin()->second == 1);
+	REQUIRE(sorted[kab::shared_string("beta")] == 3);
+}
+
+TEST_CASE("Case Insensitive Hash", "[case]") {
+	kab::shared_string const a(mixed);
+	kab::shared_string const b(lower);
+
+	REQUIRE(kab::ihash(a) == kab::ihash(b));
+	REQUIRE(kab::ihash(a) == std::hash<kab::shared_string>()(b));
+	REQUIRE(kab::ihash(a.substr(3, 20)) == kab::ihash(b.substr(3, 20)));
+
+	std::unordered_map<kab::shared_string, int, kab::case_insensitive_hash, kab::case_insensitive_equal> headers;
+	headers[kab::shared_string("Content-Length")] = 1;
+	headers[kab::shared_string("HOST")] = 2;
+	REQUIRE(headers.count(kab::shared_string("content-length")) == 1);
+	REQUIRE(headers.at(kab::shared_string("Host")) == 2);
+	REQUIRE(headers.count(kab::shared_string("accept")) == 0);
+}
+
+TEST_CASE("Case Insensitive Lower Case Flag", "[case]") {
+	using namespace kab::literals;
+
+	kab::shared_string const a(lower);
+	kab::shared_string const b(mixed);
+	REQUIRE(kab::is_ascii_lower(a));
+	REQUIRE(!kab::is_ascii_lower(b));
+
+	// The flag is cached in the block, so copies see it, and ihash sets it as well
+	auto const copy = a;
+	REQUIRE(kab::is_ascii_lower(copy));
+	kab::shared_string const hashed(lower);
+	kab::ihash(hashed);
+	REQUIRE(kab::iequals(hashed, a));
+
+	// A substring may differ from its block
+	REQUIRE(kab::is_ascii_lower(b.substr(1, 6)));
+	REQUIRE(!kab::is_ascii_lower(b.substr(0, 7)));
+	REQUIRE(kab::is_ascii_lower(kab::shared_string("literal"_ss)));
+	REQUIRE(!kab::is_ascii_lower(kab::shared_string("Literal"_ss)));
+}
+
+TEST_CASE("Case Insensitive Find", "[case]") {
+	kab::shared_string const s(mixed);
+
+	REQUIRE(kab::ifind(s, std::string_view("application/json")) == 14);
+	REQUIRE(kab::ifind(s, std::string_view("CHARSET")) == 32);
+	REQUIRE(kab::ifind(s, std::string_view("t"), 5) == 6);
+	REQUIRE(kab::ifind(s, std::string_view("xml")) == kab::shared_string::npos);
+	REQUIRE(kab::ifind(s, std::string_view("")) == 0);
+	REQUIRE(kab::ifind(s, std::string_view(mixed + "!")) == kab::shared_string::npos);
+	REQUIRE(kab::ifind(s, std::string_view("\xC3\xA9")) == s.size() - 2);
+
+	// Every position, with the match at the end of the vectorized loop and in its tail
+	for(std::size_t length = 1; length < 40; ++length) {
+		std::string haystack(length, 'a');
+		haystack.back() = 'Z';
+		REQUIRE(kab::ifind(kab::shared_string(haystack), std::string_view("az")) == (length >= 2 ? length - 2 : kab::shared_string::npos));
+	}
+}
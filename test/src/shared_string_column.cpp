@@ -0,0 +1,221 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <shared_string_column.hpp>
+
+#include <string>
+#include <vector>
+#include <optional>
+
+TEST_CASE("Column Push And Extract", "[column]") {
+	kab::shared_string_column column(4, 8);
+	REQUIRE(column.empty());
+
+	std::vector<std::string> values;
+	for(int i = 0; i < 100; ++i) {
+		values.push_back(std::string(static_cast<std::size_t>(i % 7), 'a' + static_cast<char>(i % 26)) + std::to_string(i));
+		column.push_back(values.back());
+	}
+
+	REQUIRE(column.size() == 100);
+	REQUIRE(column.get_chunk_count() == 25);
+	for(std::size_t i = 0; i < values.size(); ++i) {
+		auto const s = column[i];
+		REQUIRE(std::string_view(s.data(), s.size()) == values[i]);
+		REQUIRE(column.view(i) == values[i]);
+	}
+
+	REQUIRE_THROWS_AS(kab::shared_string_column(0), std::invalid_argument);
+}
+
+TEST_CASE("Column Rows Share The Chunk Block", "[column]") {
+	kab::shared_string_column column(16, 64);
+	column.push_back("first");
+	column.push_back("second");
+
+	auto const first = column[0];
+	auto const second = column[1];
+	REQUIRE(second.data() == first.data() + first.size());
+
+	// Growing the chunk's block leaves the extracted rows untouched
+	column.push_back(std::string(200, 'x'));
+	REQUIRE(std::string_view(first.data(), first.size()) == "first");
+	REQUIRE(std::string_view(second.data(), second.size()) == "second");
+	REQUIRE(column.view(2) == std::string(200, 'x'));
+	REQUIRE(column[1] == second);
+}
+
+TEST_CASE("Column Chunks Only Hold Pushed Rows", "[column]") {
+	kab::shared_string_column column(4, 64);
+	column.push_back("first");
+	column.push_back("second");
+
+	auto const chunk = column.get_chunk(0);
+	REQUIRE(chunk.data == kab::shared_string("firstsecond"));
+	REQUIRE(chunk.rows == 2);
+	REQUIRE((*chunk.offsets)[chunk.rows] == static_cast<std::int64_t>(chunk.data.size()));
+
+	// Later rows are written past the characters the chunk views
+	column.push_back("third");
+	REQUIRE(chunk.data == kab::shared_string("firstsecond"));
+	REQUIRE(chunk.rows == 2);
+	REQUIRE(column.get_chunk(0).data == kab::shared_string("firstsecondthird"));
+	REQUIRE(column.get_chunk(0).rows == 3);
+	REQUIRE(column.get_chunk(0).data.data() == chunk.data.data());
+
+	// Even once a later row moves the chunk to a larger block, its rows all end inside its data
+	column.push_back(std::string(100, 'x'));
+	REQUIRE(chunk.data == kab::shared_string("firstsecond"));
+	REQUIRE((*chunk.offsets)[chunk.rows] == static_cast<std::int64_t>(chunk.data.size()));
+	REQUIRE(column.get_chunk(0).rows == 4);
+}
+
+TEST_CASE("Column Rows Only Share Written Characters", "[column]") {
+	kab::shared_string_column column(3, 64);
+	column.push_back("first");
+	column.push_back("second");
+
+	// The rest of the last chunk's block is not written yet, so a row reaches no further than its own end
+	auto const first = column[0];
+	auto const second = column[1];
+	REQUIRE(first.block_size() == 5);
+	REQUIRE(second.block_size() == 11);
+	REQUIRE(second.share(std::string_view(first.data(), 11)) == kab::shared_string("firstsecond"));
+	REQUIRE_THROWS_AS(first.share(std::string_view(first.data(), 11)), std::out_of_range);
+	REQUIRE_THROWS_AS(second.share(std::string_view(second.data(), 7)), std::out_of_range);
+
+	// Once the chunk is full, the whole block can be shared, and the characters no row wrote are value initialized
+	column.push_back("third");
+	REQUIRE(first.block_size() == 64);
+	auto const tail = first.share(std::string_view(first.data() + 16, 48));
+	REQUIRE(tail == kab::shared_string(std::string(48, '\0')));
+}
+
+TEST_CASE("Column Move", "[column]") {
+	kab::shared_string_column column(4, 64);
+	column.push_back("first");
+	column.push_back("second");
+
+	kab::shared_string_column moved(std::move(column));
+	REQUIRE(moved.size() == 2);
+	REQUIRE(moved.view(1) == "second");
+	REQUIRE(column.empty());
+	REQUIRE(column.get_chunk_count() == 0);
+	column.push_back("reused");
+	REQUIRE(column.view(0) == "reused");
+
+	// Assigning over a column seals the block of its last chunk, since no row is written to it anymore
+	auto const row = moved[0];
+	REQUIRE(kab::detail::flags_access::get_block(row) == nullptr);
+	moved = std::move(column);
+	REQUIRE(kab::detail::flags_access::get_block(row) != nullptr);
+	REQUIRE(row.block_size() == 64);
+	REQUIRE(moved.size() == 1);
+	REQUIRE(moved.view(0) == "reused");
+	REQUIRE(column.size() == 0);
+	REQUIRE(column.get_chunk_count() == 0);
+}
+
+TEST_CASE("Column Scan", "[column]") {
+	kab::shared_string_column column(3);
+	for(int i = 0; i < 20; ++i) {
+		column.push_back(i % 4 == 0 ? "GET" : i % 4 == 1 ? "POST" : "PUT");
+	}
+	column.push_back("");
+
+	REQUIRE(column.count("GET") == 5);
+	REQUIRE(column.count("POST") == 5);
+	REQUIRE(column.count("PUT") == 10);
+	REQUIRE(column.count("") == 1);
+	REQUIRE(column.count("DELETE") == 0);
+
+	std::size_t expected_row = 0;
+	std::size_t characters = 0;
+	column.for_each([&](std::size_t row, std::string_view value) {
+		REQUIRE(row == expected_row++);
+		characters += value.size();
+	});
+	REQUIRE(expected_row == 21);
+	REQUIRE(characters == 5 * 3 + 5 * 4 + 10 * 3);
+}
+
+TEST_CASE("Dictionary Column Encode And Decode", "[column]") {
+	std::vector<std::string> const values = { "US", "FR", "US", "CA", "FR", "US" };
+
+	kab::dictionary_column column;
+	column.encode(values.begin(), values.end());
+
+	REQUIRE(column.size() == 6);
+	REQUIRE(column.get_dictionary().size() == 3);
+	REQUIRE(column.get_codes() == std::vector<std::uint32_t>{ 0, 1, 0, 2, 1, 0 });
+
+	std::vector<kab::shared_string> decoded;
+	column.decode(0, column.size(), std::back_inserter(decoded));
+	REQUIRE(decoded.size() == 6);
+	for(std::size_t i = 0; i < values.size(); ++i) {
+		REQUIRE(std::string_view(decoded[i].data(), decoded[i].size()) == values[i]);
+	}
+	REQUIRE(decoded[0].data() == decoded[2].data()); // equal rows share the dictionary's value
+	REQUIRE(column[3] == decoded[3]);
+}
+
+TEST_CASE("Dictionary Column Shares Pushed Strings", "[column]") {
+	kab::shared_string const value("GET");
+
+	kab::dictionary_column column;
+	column.push_back(value);
+	column.push_back("GET");
+
+	REQUIRE(column.get_dictionary().size() == 1);
+	REQUIRE(column[0].data() == value.data());
+	REQUIRE(column[1].data() == value.data());
+}
+
+TEST_CASE("Dictionary Column Copy", "[column]") {
+	std::optional<kab::dictionary_column> original(std::in_place);
+	for(char const* value : { "GET", "POST", "GET", "PUT" }) {
+		original->push_back(value);
+	}
+
+	kab::dictionary_column copy(*original);
+	kab::dictionary_column assigned;
+	assigned.push_back("DELETE");
+	assigned = copy;
+	original.reset();
+
+	for(kab::dictionary_column const* column : { &copy, &assigned }) {
+		REQUIRE(column->size() == 4);
+		REQUIRE(column->find_code("PUT") == std::optional<std::uint32_t>(2));
+		REQUIRE(!column->find_code("DELETE").has_value());
+		REQUIRE(column->filter_equal("GET") == std::vector<std::size_t>{ 0, 2 });
+	}
+	REQUIRE(copy[1].data() == assigned[1].data());
+}
+
+TEST_CASE("Dictionary Column Filters", "[column]") {
+	kab::basic_dictionary_column<char, std::uint8_t> column;
+	for(int i = 0; i < 12; ++i) {
+		column.push_back(i % 3 == 0 ? "GET" : i % 3 == 1 ? "POST" : "PUT");
+	}
+
+	REQUIRE(column.find_code("POST") == std::optional<std::uint8_t>(1));
+	REQUIRE(!column.find_code("DELETE").has_value());
+
+	REQUIRE(column.filter_equal("GET") == std::vector<std::size_t>{ 0, 3, 6, 9 });
+	REQUIRE(column.filter_equal("DELETE").empty());
+
+	std::vector<std::string_view> const methods = { "PUT", "DELETE", "GET" };
+	REQUIRE(column.filter_in(methods.begin(), methods.end()) == std::vector<std::size_t>{ 0, 2, 3, 5, 6, 8, 9, 11 });
+}
+
+TEST_CASE("Dictionary Column Code Overflow", "[column]") {
+	kab::basic_dictionary_column<char, std::uint8_t> column;
+	for(int i = 0; i < 256; ++i) {
+		column.push_back(std::to_string(i));
+	}
+	REQUIRE_THROWS_AS(column.push_back("256"), std::length_error);
+	REQUIRE_NOTHROW(column.push_back("255"));
+}
@@ -0,0 +1,24 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <greeting.hpp>
+
+#include <string_view>
+
+TEST_CASE("Embedded File", "[embed]") {
+	std::string_view const expected = "Hello, {{name}}!\nCaf\xc3\xa9 au lait\n";
+	REQUIRE(test_data::greeting.size() == expected.size());
+	REQUIRE(std::string_view(test_data::greeting) == expected);
+
+	// Embedded strings are immortal, so substrings share their static storage
+	auto const name = test_data::greeting.substr(7, 8);
+	REQUIRE(std::string_view(name) == "{{name}}");
+	REQUIRE(name.data() == test_data::greeting.data() + 7);
+}
+
+#if __cpp_constexpr >= 201907L
+static_assert(test_data::greeting.find("{{name}}") == 7);
+#endif
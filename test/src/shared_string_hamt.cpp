@@ -0,0 +1,113 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <shared_string_hamt.hpp>
+
+#include <string>
+
+namespace {
+	using map = kab::basic_persistent_map<kab::shared_string, int>;
+
+	// Every key lands in the same collision node
+	struct colliding_hash {
+		auto operator()(kab::shared_string const&) const noexcept -> std::size_t { return 42; }
+	};
+	using colliding_map = kab::basic_persistent_map<kab::shared_string, int, colliding_hash>;
+
+	auto key(int i) -> kab::shared_string {
+		return kab::shared_string("key" + std::to_string(i));
+	}
+}
+
+TEST_CASE("Persistent Map Set And Find", "[hamt]") {
+	map m;
+	REQUIRE(m.empty());
+	REQUIRE(m.find(key(0)) == nullptr);
+
+	for(int i = 0; i < 10000; ++i) {
+		m = m.set(key(i), i);
+	}
+	REQUIRE(m.size() == 10000);
+	for(int i = 0; i < 10000; ++i) {
+		REQUIRE(m.find(key(i)) != nullptr);
+		REQUIRE(*m.find(key(i)) == i);
+	}
+	REQUIRE(!m.contains(key(10000)));
+
+	m = m.set(key(5), -5);
+	REQUIRE(m.size() == 10000);
+	REQUIRE(*m.find(key(5)) == -5);
+
+	std::size_t visited = 0;
+	m.for_each([&](kab::shared_string const&, int) { ++visited; });
+	REQUIRE(visited == 10000);
+}
+
+TEST_CASE("Persistent Map Versions", "[hamt]") {
+	map v1;
+	for(int i = 0; i < 1000; ++i) {
+		v1 = v1.set(key(i), i);
+	}
+
+	auto const snapshot = v1;
+	auto const v2 = v1.set(key(1), 100).set(key(2000), 2000).erase(key(3));
+
+	REQUIRE(snapshot.size() == 1000);
+	REQUIRE(*snapshot.find(key(1)) == 1);
+	REQUIRE(!snapshot.contains(key(2000)));
+	REQUIRE(snapshot.contains(key(3)));
+
+	REQUIRE(v2.size() == 1000);
+	REQUIRE(*v2.find(key(1)) == 100);
+	REQUIRE(*v2.find(key(2000)) == 2000);
+	REQUIRE(!v2.contains(key(3)));
+
+	// Unmodified values are shared, not copied
+	REQUIRE(snapshot.find(key(500)) == v2.find(key(500)));
+}
+
+TEST_CASE("Persistent Map Erase", "[hamt]") {
+	map m;
+	for(int i = 0; i < 1000; ++i) {
+		m = m.set(key(i), i);
+	}
+	REQUIRE(m.erase(key(1000)).size() == 1000);
+
+	for(int i = 0; i < 1000; i += 2) {
+		m = m.erase(key(i));
+	}
+	REQUIRE(m.size() == 500);
+	for(int i = 0; i < 1000; ++i) {
+		REQUIRE(m.contains(key(i)) == (i % 2 == 1));
+	}
+
+	for(int i = 1; i < 1000; i += 2) {
+		m = m.erase(key(i));
+	}
+	REQUIRE(m.empty());
+	REQUIRE(!m.contains(key(1)));
+}
+
+TEST_CASE("Persistent Map Hash Collisions", "[hamt]") {
+	colliding_map m;
+	for(int i = 0; i < 10; ++i) {
+		m = m.set(key(i), i);
+	}
+	REQUIRE(m.size() == 10);
+	for(int i = 0; i < 10; ++i) {
+		REQUIRE(*m.find(key(i)) == i);
+	}
+
+	m = m.set(key(3), 30).erase(key(4));
+	REQUIRE(m.size() == 9);
+	REQUIRE(*m.find(key(3)) == 30);
+	REQUIRE(!m.contains(key(4)));
+
+	for(int i = 0; i < 10; ++i) {
+		m = m.erase(key(i));
+	}
+	REQUIRE(m.empty());
+}
@@ -0,0 +1,103 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <shared_string_sketch.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+	using space_saving = kab::basic_space_saving<kab::shared_string>;
+	using hyperloglog = kab::basic_hyperloglog<kab::shared_string>;
+
+	// Five hot values appearing 100 to 500 times, among 2000 values appearing once or twice
+	auto make_stream() -> std::vector<kab::shared_string> {
+		std::vector<kab::shared_string> stream;
+		for(int round = 0; round < 500; ++round) {
+			for(int hot = 0; hot < 5; ++hot) {
+				if(round < (hot + 1) * 100) {
+					stream.emplace_back("hot" + std::to_string(hot));
+				}
+			}
+			for(int cold = 0; cold < 6; ++cold) {
+				stream.emplace_back("cold" + std::to_string((round * 6 + cold) % 2000));
+			}
+		}
+		return stream;
+	}
+}
+
+TEST_CASE("Space Saving Top K", "[sketch]") {
+	auto const stream = make_stream();
+
+	space_saving summary(20);
+	for(auto const& value : stream) {
+		summary.add(value);
+	}
+
+	REQUIRE(summary.size() == 20);
+	// Only values occurring more than 4500 / 20 times are guaranteed to be tracked
+	auto const top = summary.top();
+	for(int hot = 0; hot < 3; ++hot) {
+		std::string const expected = "hot" + std::to_string(4 - hot);
+		REQUIRE(std::string_view(top[hot].value.data(), top[hot].value.size()) == expected);
+		REQUIRE(top[hot].count - top[hot].error <= std::uint64_t(500 - hot * 100));
+		REQUIRE(top[hot].count >= std::uint64_t(500 - hot * 100));
+	}
+}
+
+TEST_CASE("Space Saving Shares Values", "[sketch]") {
+	kab::shared_string const value("tracked");
+
+	space_saving summary(4);
+	summary.add(value);
+	summary.add(value);
+
+	auto const top = summary.top();
+	REQUIRE(top.size() == 1);
+	REQUIRE(top[0].count == 2);
+	REQUIRE(top[0].value.data() == value.data());
+}
+
+TEST_CASE("Space Saving Merge", "[sketch]") {
+	auto const stream = make_stream();
+
+	space_saving first(20);
+	space_saving second(20);
+	for(std::size_t i = 0; i < stream.size(); ++i) {
+		(i % 2 == 0 ? first : second).add(stream[i]);
+	}
+	first.merge(second);
+
+	REQUIRE(first.size() == 20);
+	auto const top = first.top();
+	for(int hot = 0; hot < 3; ++hot) {
+		std::string const expected = "hot" + std::to_string(4 - hot);
+		REQUIRE(std::string_view(top[hot].value.data(), top[hot].value.size()) == expected);
+		REQUIRE(top[hot].count >= std::uint64_t(500 - hot * 100));
+	}
+}
+
+TEST_CASE("HyperLogLog Estimate", "[sketch]") {
+	hyperloglog small;
+	for(int i = 0; i < 100; ++i) {
+		small.add(kab::shared_string(std::to_string(i % 50)));
+	}
+	REQUIRE(small.estimate() == Approx(50).epsilon(0.05));
+
+	hyperloglog large;
+	hyperloglog first;
+	hyperloglog second;
+	for(int i = 0; i < 100000; ++i) {
+		kab::shared_string const value(std::to_string(i));
+		large.add(value);
+		(i % 3 == 0 ? first : second).add(value);
+	}
+	REQUIRE(large.estimate() == Approx(100000).epsilon(0.05));
+
+	first.merge(second);
+	REQUIRE(first.estimate() == large.estimate());
+}
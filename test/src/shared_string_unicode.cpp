@@ -0,0 +1,234 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <shared_string_unicode.hpp>
+#include <shared_string_column.hpp>
+
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+	auto find_invalid(std::string const& s) -> std::size_t {
+		return kab::detail::find_invalid_utf8(reinterpret_cast<unsigned char const*>(s.data()), s.size());
+	}
+
+	// Independent check: decodes without validating, and requires the encoding of the result to be the same bytes
+	bool is_valid_sequence(unsigned char const* bytes, std::size_t size) {
+		std::uint32_t cp;
+		if(size == 2) cp = (bytes[0] & 0x1Fu) << 6 | (bytes[1] & 0x3Fu);
+		else if(size == 3) cp = (bytes[0] & 0x0Fu) << 12 | (bytes[1] & 0x3Fu) << 6 | (bytes[2] & 0x3Fu);
+		else cp = (bytes[0] & 0x07u) << 18 | (bytes[1] & 0x3Fu) << 12 | (bytes[2] & 0x3Fu) << 6 | (bytes[3] & 0x3Fu);
+		if(cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+			return false;
+		}
+		unsigned char encoded[4];
+		std::size_t const length = cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+		if(length == 1) encoded[0] = static_cast<unsigned char>(cp);
+		else if(length == 2) { encoded[0] = static_cast<unsigned char>(0xC0 | cp >> 6); encoded[1] = static_cast<unsigned char>(0x80 | (cp & 0x3F)); }
+		else if(length == 3) { encoded[0] = static_cast<unsigned char>(0xE0 | cp >> 12); encoded[1] = static_cast<unsigned char>(0x80 | (cp >> 6 & 0x3F)); encoded[2] = static_cast<unsigned char>(0x80 | (cp & 0x3F)); }
+		else { encoded[0] = static_cast<unsigned char>(0xF0 | cp >> 18); encoded[1] = static_cast<unsigned char>(0x80 | (cp >> 12 & 0x3F)); encoded[2] = static_cast<unsigned char>(0x80 | (cp >> 6 & 0x3F)); encoded[3] = static_cast<unsigned char>(0x80 | (cp & 0x3F)); }
+		return length == size && std::equal(encoded, encoded + size, bytes);
+	}
+}
+
+TEST_CASE("UTF-8 Validation", "[unicode]") {
+	REQUIRE(find_invalid("") == 0);
+	REQUIRE(find_invalid("plain ASCII text, longer than one vector") == 40);
+	REQUIRE(find_invalid("caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80") == 14);
+
+	REQUIRE(find_invalid("\xC0\x80") == 0); // overlong NUL
+	REQUIRE(find_invalid("ab\xE0\x80\x80") == 2); // overlong 3 bytes
+	REQUIRE(find_invalid("abc\xED\xA0\x80") == 3); // surrogate
+	REQUIRE(find_invalid("\xF4\x90\x80\x80") == 0); // above U+10FFFF
+	REQUIRE(find_invalid("\xF5\x80\x80\x80") == 0);
+	REQUIRE(find_invalid("x\x80") == 1); // lone continuation
+	REQUIRE(find_invalid("0123456789abcdef\xE2\x82") == 16); // truncated after a vector of ASCII
+	REQUIRE(find_invalid("0123456789abcde\xC3\xA9" "0123456789abcdef\xFF") == 33);
+
+	// Every 2 and 3 byte sequence, and every start of a 4 byte sequence, against an independent decoder
+	std::size_t mismatches = 0;
+	for(unsigned lead = 0xC0; lead < 0xE0; ++lead) {
+		for(unsigned second = 0; second < 0x100; ++second) {
+			unsigned char const bytes[] = { static_cast<unsigned char>(lead), static_cast<unsigned char>(second) };
+			bool const expected = (second & 0xC0) == 0x80 && is_valid_sequence(bytes, 2);
+			mismatches += (kab::detail::get_utf8_sequence_length(bytes, 2) == 2) != expected;
+		}
+	}
+	REQUIRE(mismatches == 0);
+	for(unsigned lead = 0xE0; lead < 0xF0; ++lead) {
+		for(unsigned second = 0x80; second < 0xC0; ++second) {
+			for(unsigned third = 0; third < 0x100; ++third) {
+				unsigned char const bytes[] = { static_cast<unsigned char>(lead), static_cast<unsigned char>(second), static_cast<unsigned char>(third) };
+				bool const expected = (third & 0xC0) == 0x80 && is_valid_sequence(bytes, 3);
+				mismatches += (kab::detail::get_utf8_sequence_length(bytes, 3) == 3) != expected;
+			}
+		}
+	}
+	REQUIRE(mismatches == 0);
+	for(unsigned lead = 0xF0; lead < 0xF8; ++lead) {
+		for(unsigned second = 0x80; second < 0xC0; ++second) {
+			unsigned char const bytes[] = { static_cast<unsigned char>(lead), static_cast<unsigned char>(second), 0x80, 0xBF };
+			mismatches += (kab::detail::get_utf8_sequence_length(bytes, 4) == 4) != is_valid_sequence(bytes, 4);
+		}
+	}
+	REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("UTF-8 Cached Flags", "[unicode]") {
+	using namespace kab::literals;
+
+	kab::shared_string const text("na\xC3\xAFve caf\xC3\xA9, long enough for a vector");
+	REQUIRE(kab::is_valid_utf8(text));
+	REQUIRE(!kab::is_ascii(text));
+	// Known from the block now, so copies answer without looking at the characters
+	auto const copy = text;
+	REQUIRE(kab::is_valid_utf8(copy));
+
+	// Substrings of a valid block are valid unless they cut a sequence
+	REQUIRE(kab::is_valid_utf8(text.substr(0, 2)));
+	REQUIRE(kab::is_valid_utf8(text.substr(2, 2)));
+	REQUIRE(!kab::is_valid_utf8(text.substr(3, 2)));
+	REQUIRE(!kab::is_valid_utf8(text.substr(0, 3)));
+	REQUIRE(kab::is_valid_utf8(text.substr(text.size() - 6)));
+	REQUIRE(kab::is_ascii(text.substr(5, 5)));
+
+	kab::shared_string const ascii("only ASCII characters here");
+	REQUIRE(kab::is_ascii(ascii));
+	REQUIRE(kab::is_valid_utf8(ascii));
+	REQUIRE(kab::is_ascii(ascii.substr(5, 5)));
+
+	kab::shared_string const invalid("valid prefix \xFF then garbage");
+	REQUIRE(!kab::is_valid_utf8(invalid));
+	REQUIRE(!kab::is_valid_utf8(invalid));
+	REQUIRE(kab::is_valid_utf8(invalid.substr(0, 13)));
+
+	REQUIRE(kab::is_ascii(kab::shared_string("literal"_ss)));
+	REQUIRE(!kab::is_valid_utf8(kab::shared_string("\xC3"_ss)));
+}
+
+TEST_CASE("UTF-8 Cached Flags Of Column Blocks", "[unicode]") {
+	// The column writes new rows into the block of its last chunk, so nothing is cached for it until it is full
+	kab::shared_string_column column(4, 3);
+	column.push_back("abc");
+	auto const whole = column.get_chunk(0).data;
+	REQUIRE(whole.block_size() == whole.size());
+	REQUIRE(kab::is_valid_utf8(whole));
+	REQUIRE(kab::is_ascii(whole));
+	REQUIRE(kab::detail::flags_access::get(whole) == nullptr);
+
+	column.push_back("\xFF\xFE");
+	REQUIRE(!kab::is_valid_utf8(column[1]));
+	REQUIRE(!kab::is_ascii(column[1]));
+	REQUIRE(kab::is_ascii(column[0]));
+
+	// A full chunk is never written again, so its block caches properties like any other
+	kab::shared_string_column exact(2, 4);
+	exact.push_back("ab");
+	exact.push_back("cd");
+	auto const sealed = exact.get_chunk(0).data;
+	REQUIRE(sealed.block_size() == sealed.size());
+	REQUIRE(kab::is_ascii(sealed));
+	REQUIRE(kab::detail::flags_access::get(sealed) != nullptr);
+}
+
+TEST_CASE("UTF-8 Code Points", "[unicode]") {
+	kab::shared_string const text("\xF0\x9F\x98\x80 na\xC3\xAFve caf\xC3\xA9 and some ASCII after it");
+	REQUIRE(kab::count_code_points(text) == 36);
+	REQUIRE(kab::get_code_point_offset(text, 0) == 0);
+	REQUIRE(kab::get_code_point_offset(text, 1) == 4);
+	REQUIRE(kab::get_code_point_offset(text, 5) == 9);
+	REQUIRE(kab::get_code_point_offset(text, 36) == text.size());
+
+	kab::shared_string const ascii("ASCII only");
+	REQUIRE(kab::count_code_points(ascii) == 10);
+	REQUIRE(kab::get_code_point_offset(ascii, 6) == 6);
+}
+
+TEST_CASE("Transcoding", "[unicode]") {
+	// ASCII long enough for the vector paths, then 2, 3 and 4 byte sequences, then ASCII again
+	std::string const utf8 = "ASCII prefix over one vector, na\xC3\xAFve \xE2\x82\xAC \xF0\x9F\x98\x80\xF0\x9F\x98\x81 suffix";
+	std::u16string const utf16 = u"ASCII prefix over one vector, naïve € \U0001F600\U0001F601 suffix";
+	std::u32string const utf32 = U"ASCII prefix over one vector, naïve € \U0001F600\U0001F601 suffix";
+
+	kab::shared_string const s8(utf8);
+	kab::shared_u16string const s16(utf16);
+	kab::shared_u32string const s32(utf32);
+
+	auto const check = [](auto const& result, auto const& expected) {
+		REQUIRE(result.view() == expected);
+		// Written in a block of exactly the size of the result
+		REQUIRE(result.block_size() == result.size());
+	};
+	check(kab::to_utf16(s8), utf16);
+	check(kab::to_utf32(s8), utf32);
+	check(kab::to_utf8(s16), utf8);
+	check(kab::to_utf32(s16), utf32);
+	check(kab::to_utf8(s32), utf8);
+	check(kab::to_utf16(s32), utf16);
+	check(kab::to_utf8(s8), utf8);
+
+	// Substrings only transcode what they view
+	REQUIRE(kab::to_utf16(s8.substr(utf8.size() - 15)).view() == utf16.substr(utf16.size() - 11));
+
+	REQUIRE(kab::to_utf16(kab::shared_string()).empty());
+	REQUIRE(kab::to_utf8(kab::shared_u32string()).empty());
+
+	kab::shared_u16string const ascii(u"only ASCII code units, more than a vector of them");
+	auto const narrowed = kab::to_utf8(ascii);
+	REQUIRE(narrowed.view() == "only ASCII code units, more than a vector of them");
+	REQUIRE(kab::is_ascii(narrowed));
+	REQUIRE(kab::is_valid_utf8(kab::to_utf8(s32)));
+	REQUIRE(!kab::is_ascii(kab::to_utf8(s32)));
+
+	REQUIRE(kab::transcode<kab::shared_wstring>(s8).view() == std::wstring(L"ASCII prefix over one vector, naïve € \U0001F600\U0001F601 suffix"));
+}
+
+TEST_CASE("Transcoding Errors", "[unicode]") {
+	auto const position = [](auto const& s) -> std::size_t {
+		try {
+			kab::to_utf8(s);
+		} catch(kab::encoding_error const& e) {
+			return e.get_position();
+		}
+		try {
+			kab::to_utf16(s);
+		} catch(kab::encoding_error const&) {
+			FAIL("to_utf8 accepted what to_utf16 rejected");
+		}
+		return std::string::npos;
+	};
+	auto const position8 = [](std::string const& s) -> std::size_t {
+		try {
+			kab::to_utf32(kab::shared_string(s));
+		} catch(kab::encoding_error const& e) {
+			return e.get_position();
+		}
+		return std::string::npos;
+	};
+
+	REQUIRE(position8("0123456789abcdef0123\xC3") == 20);
+	REQUIRE(position8("caf\xC3\xA9\xED\xA0\x80") == 5);
+	REQUIRE(position8("\xC0\x80") == 0);
+
+	std::u16string lone_high = u"0123456789abcdef";
+	lone_high += char16_t(0xD83D);
+	REQUIRE(position(kab::shared_u16string(lone_high)) == 16);
+	lone_high += u"x";
+	REQUIRE(position(kab::shared_u16string(lone_high)) == 16);
+	std::u16string lone_low = u"ab";
+	lone_low += char16_t(0xDE00);
+	REQUIRE(position(kab::shared_u16string(lone_low)) == 2);
+
+	std::u32string out_of_range = U"abc";
+	out_of_range += char32_t(0x110000);
+	REQUIRE(position(kab::shared_u32string(out_of_range)) == 3);
+	std::u32string surrogate = U"é";
+	surrogate += char32_t(0xDFFF);
+	REQUIRE(position(kab::shared_u32string(surrogate)) == 1);
+
+	REQUIRE(position(kab::shared_u32string(U"\U0010FFFF")) == std::string::npos);
+}
@@ -0,0 +1,155 @@
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+
+#include <small_vector.hpp>
+
+#include <string>
+#include <stdexcept>
+
+namespace {
+	// Counts the moves the container makes, to tell relocation by memcpy apart from move construction
+	template<bool Relocatable>
+	struct tracked {
+		static inline int moves = 0;
+
+		explicit tracked(int value) : value(value) {}
+		tracked(tracked const&) = default;
+		tracked(tracked && other) noexcept : value(other.value) { ++moves; }
+		~tracked() {}
+
+		int value;
+	};
+
+	// Counts the live objects, and throws from its copy constructor once the copy budget is spent
+	struct copy_limited {
+		static inline int live = 0;
+		static inline int copies_left = 0;
+
+		explicit copy_limited(int value) : value(value) { ++live; }
+		copy_limited(copy_limited const& other) : value(other.value) {
+			if(copies_left == 0) {
+				throw std::runtime_error("Copy budget spent");
+			}
+			--copies_left;
+			++live;
+		}
+		copy_limited(copy_limited && other) noexcept : value(other.value) { ++live; }
+		~copy_limited() { --live; }
+
+		int value;
+	};
+}
+
+namespace kab {
+	template<>
+	struct is_trivially_relocatable<tracked<true>> : std::true_type {};
+}
+
+static_assert(kab::is_trivially_relocatable_v<kab::shared_string>);
+static_assert(kab::is_trivially_relocatable_v<kab::shared_u32string>);
+static_assert(!kab::is_trivially_relocatable_v<std::string>);
+static_assert(std::is_nothrow_move_assignable_v<kab::shared_string>);
+
+TEST_CASE("Small Vector Shared Strings", "[small_vector]") {
+	kab::small_vector<kab::shared_string, 4> strings;
+	REQUIRE(strings.empty());
+	REQUIRE(strings.is_inline());
+
+	std::vector<char const*> data;
+	for(int i = 0; i < 1000; ++i) {
+		strings.emplace_back(std::to_string(i));
+		data.push_back(strings.back().data());
+		REQUIRE(strings.is_inline() == (i < 4));
+	}
+
+	REQUIRE(strings.size() == 1000);
+	for(int i = 0; i < 1000; ++i) {
+		REQUIRE(std::string_view(strings[i].data(), strings[i].size()) == std::to_string(i));
+		REQUIRE(strings[i].data() == data[i]);
+	}
+
+	strings.push_back(strings[0]); // refers to an element of the vector while it grows
+	REQUIRE(strings.back() == strings[0]);
+
+	strings.pop_back();
+	REQUIRE(strings.size() == 1000);
+	strings.clear();
+	REQUIRE(strings.empty());
+}
+
+TEST_CASE("Small Vector Relocation", "[small_vector]") {
+	tracked<true>::moves = 0;
+	tracked<false>::moves = 0;
+
+	kab::small_vector<tracked<true>, 2> relocated;
+	kab::small_vector<tracked<false>, 2> moved;
+	for(int i = 0; i < 100; ++i) {
+		relocated.emplace_back(i);
+		moved.emplace_back(i);
+	}
+	REQUIRE(tracked<true>::moves == 0);
+	REQUIRE(tracked<false>::moves > 0);
+
+	for(int i = 0; i < 100; ++i) {
+		REQUIRE(relocated[i].value == i);
+		REQUIRE(moved[i].value == i);
+	}
+}
+
+TEST_CASE("Small Vector Copy And Move", "[small_vector]") {
+	using namespace kab::literals;
+	using vector = kab::small_vector<kab::shared_string, 2>;
+
+	vector inline_strings;
+	inline_strings.push_back("first"_ss);
+
+	vector heap_strings;
+	for(int i = 0; i < 3; ++i) {
+		heap_strings.emplace_back(std::to_string(i));
+	}
+
+	vector const copy = heap_strings;
+	REQUIRE(copy.size() == 3);
+	REQUIRE(copy[2].data() == heap_strings[2].data());
+
+	auto const heap_data = heap_strings.data();
+	vector moved_heap = std::move(heap_strings);
+	REQUIRE(moved_heap.data() == heap_data);
+	REQUIRE(heap_strings.empty());
+
+	vector moved_inline = std::move(inline_strings);
+	REQUIRE(moved_inline.is_inline());
+	REQUIRE(moved_inline[0] == "first"_ss);
+	REQUIRE(inline_strings.empty());
+
+	moved_inline = copy;
+	REQUIRE(moved_inline.size() == 3);
+	moved_inline = std::move(moved_heap);
+	REQUIRE(moved_inline.data() == heap_data);
+}
+
+TEST_CASE("Small Vector Throwing Copy", "[small_vector]") {
+	using vector = kab::small_vector<copy_limited, 2>;
+	{
+		vector values;
+		for(int i = 0; i < 5; ++i) {
+			values.emplace_back(i);
+		}
+		REQUIRE(copy_limited::live == 5);
+
+		// The elements copied before the throw, and the new buffer, are freed
+		copy_limited::copies_left = 3;
+		REQUIRE_THROWS_AS(vector(values), std::runtime_error);
+		REQUIRE(copy_limited::live == 5);
+
+		copy_limited::copies_left = 5;
+		vector const copy(values);
+		REQUIRE(copy.size() == 5);
+		REQUIRE(copy[4].value == 4);
+		REQUIRE(copy_limited::live == 10);
+	}
+	REQUIRE(copy_limited::live == 0);
+}